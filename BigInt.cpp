@@ -0,0 +1,484 @@
+#include "BigInt.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+// Largest power of base which is not greater than RADIX_LIMB_BASE, and its exponent
+static uint64_t radixLimb(unsigned int base, size_t* digits)
+{
+    uint64_t limb = base;
+    *digits = 1;
+    while (limb * base <= RADIX_LIMB_BASE)
+    {
+        limb *= base;
+        (*digits)++;
+    }
+    return limb;
+}
+
+BigInt::BigInt()
+{
+    this->isNegative = false;
+}
+
+BigInt::BigInt(int64_t n)
+{
+    this->isNegative = n < 0;
+    // Negate in unsigned arithmetic so that INT64_MIN does not overflow
+    this->magnitude = NumberKernel::fromWord(n < 0 ? 0 - (uint64_t)n : (uint64_t)n, BIGINT_BASE);
+}
+
+BigInt::BigInt(const std::string& n)
+{
+    BigInt result;
+    if (fromString(n, 10, result) == false)
+    {
+        throw std::domain_error("BigInt: invalid integer \"" + n + "\"");
+    }
+    *this = result;
+}
+
+BigInt::BigInt(const Number& n)
+{
+    // Pack the integer digits into base LIMB_BASE limbs, the lowest limb first
+    size_t size = n.primary.size();
+    NumberKernel::Limbs limbs((size + LIMB_DIGITS - 1) / LIMB_DIGITS, 0);
+    for (size_t i = 0; i < size; i++)
+    {
+        limbs[(size - 1 - i) / LIMB_DIGITS] = limbs[(size - 1 - i) / LIMB_DIGITS] * 10 + n.primary[i];
+    }
+    NumberKernel::trim(limbs);
+    *this = fromMagnitude(NumberKernel::convert(limbs, LIMB_BASE, BIGINT_BASE), n.isNegative);
+}
+
+BigInt BigInt::fromMagnitude(NumberKernel::Limbs magnitude, bool isNegative)
+{
+    BigInt result;
+    NumberKernel::trim(magnitude);
+    result.isNegative = isNegative && magnitude.size() > 0;
+    result.magnitude.swap(magnitude);
+    return result;
+}
+
+NumberKernel::Limbs BigInt::multiplyMagnitudes(const NumberKernel::Limbs& a, const NumberKernel::Limbs& b)
+{
+    // The kernel only uses NTT for bases up to RADIX_LIMB_BASE, splitting each limb in two halves is linear
+    if (std::min(a.size(), b.size()) * 2 >= NumberKernel::getNttThreshold())
+    {
+        NumberKernel::Limbs product = NumberKernel::multiply(NumberKernel::convert(a, BIGINT_BASE, RADIX_LIMB_BASE), NumberKernel::convert(b, BIGINT_BASE, RADIX_LIMB_BASE), RADIX_LIMB_BASE);
+        return NumberKernel::convert(product, RADIX_LIMB_BASE, BIGINT_BASE);
+    }
+    return NumberKernel::multiply(a, b, BIGINT_BASE);
+}
+
+NumberKernel::Limbs BigInt::toTwosComplement(size_t size) const
+{
+    NumberKernel::Limbs result = this->magnitude;
+    result.resize(size, 0);
+    if (this->isNegative)
+    {
+        // -m is ~(m - 1), m is not zero
+        for (size_t i = 0; result[i]-- == 0; i++)
+        {
+        }
+        for (uint32_t& limb : result)
+        {
+            limb = ~limb;
+        }
+    }
+    return result;
+}
+
+BigInt BigInt::fromTwosComplement(NumberKernel::Limbs limbs)
+{
+    bool isNegative = limbs.size() > 0 && (limbs.back() >> (BIGINT_LIMB_BITS - 1)) != 0;
+    if (isNegative)
+    {
+        for (uint32_t& limb : limbs)
+        {
+            limb = ~limb;
+        }
+        for (size_t i = 0; ++limbs[i] == 0; i++)
+        {
+        }
+    }
+    return fromMagnitude(limbs, isNegative);
+}
+
+BigInt BigInt::bitwise(const BigInt& a, const BigInt& b, BitOperation operation)
+{
+    // One extra limb holds the sign bit
+    size_t size = std::max(a.magnitude.size(), b.magnitude.size()) + 1;
+    NumberKernel::Limbs x = a.toTwosComplement(size);
+    NumberKernel::Limbs y = b.toTwosComplement(size);
+    for (size_t i = 0; i < size; i++)
+    {
+        switch (operation)
+        {
+        case AND:
+            x[i] &= y[i];
+            break;
+        case OR:
+            x[i] |= y[i];
+            break;
+        case XOR:
+            x[i] ^= y[i];
+            break;
+        }
+    }
+    return fromTwosComplement(x);
+}
+
+int BigInt::compare(const BigInt& a, const BigInt& b)
+{
+    if (a.isNegative != b.isNegative)
+    {
+        return a.isNegative ? -1 : 1;
+    }
+    int result = NumberKernel::compare(a.magnitude, b.magnitude);
+    return a.isNegative ? -result : result;
+}
+
+BigInt BigInt::operator - () const
+{
+    return fromMagnitude(this->magnitude, !this->isNegative);
+}
+
+BigInt BigInt::operator + (const BigInt& n) const
+{
+    if (this->isNegative == n.isNegative)
+    {
+        return fromMagnitude(NumberKernel::add(this->magnitude, n.magnitude, BIGINT_BASE), this->isNegative);
+    }
+    if (NumberKernel::compare(this->magnitude, n.magnitude) >= 0)
+    {
+        return fromMagnitude(NumberKernel::subtract(this->magnitude, n.magnitude, BIGINT_BASE), this->isNegative);
+    }
+    return fromMagnitude(NumberKernel::subtract(n.magnitude, this->magnitude, BIGINT_BASE), n.isNegative);
+}
+
+BigInt BigInt::operator - (const BigInt& n) const
+{
+    return *this + (-n);
+}
+
+BigInt BigInt::operator * (const BigInt& n) const
+{
+    return fromMagnitude(multiplyMagnitudes(this->magnitude, n.magnitude), this->isNegative != n.isNegative);
+}
+
+BigInt BigInt::operator / (const BigInt& n) const
+{
+    if (n.magnitude.size() == 0)
+    {
+        throw std::domain_error("BigInt: division by zero");
+    }
+    NumberKernel::Limbs quotient;
+    NumberKernel::divide(this->magnitude, n.magnitude, BIGINT_BASE, &quotient, nullptr);
+    return fromMagnitude(quotient, this->isNegative != n.isNegative);
+}
+
+BigInt BigInt::operator % (const BigInt& n) const
+{
+    if (n.magnitude.size() == 0)
+    {
+        throw std::domain_error("BigInt: division by zero");
+    }
+    NumberKernel::Limbs remainder;
+    NumberKernel::divide(this->magnitude, n.magnitude, BIGINT_BASE, nullptr, &remainder);
+    return fromMagnitude(remainder, this->isNegative);
+}
+
+bool BigInt::operator == (const BigInt& n) const
+{
+    return this->isNegative == n.isNegative && this->magnitude == n.magnitude;
+}
+
+bool BigInt::operator != (const BigInt& n) const
+{
+    return !(*this == n);
+}
+
+bool BigInt::operator < (const BigInt& n) const
+{
+    return compare(*this, n) < 0;
+}
+
+bool BigInt::operator > (const BigInt& n) const
+{
+    return compare(*this, n) > 0;
+}
+
+bool BigInt::operator <= (const BigInt& n) const
+{
+    return compare(*this, n) <= 0;
+}
+
+bool BigInt::operator >= (const BigInt& n) const
+{
+    return compare(*this, n) >= 0;
+}
+
+BigInt BigInt::operator ~ () const
+{
+    return -*this - BigInt(1);
+}
+
+BigInt BigInt::operator & (const BigInt& n) const
+{
+    return bitwise(*this, n, AND);
+}
+
+BigInt BigInt::operator | (const BigInt& n) const
+{
+    return bitwise(*this, n, OR);
+}
+
+BigInt BigInt::operator ^ (const BigInt& n) const
+{
+    return bitwise(*this, n, XOR);
+}
+
+BigInt BigInt::operator << (size_t shift) const
+{
+    if (this->magnitude.size() == 0)
+    {
+        return BigInt();
+    }
+    size_t words = shift / BIGINT_LIMB_BITS;
+    unsigned int bits = shift % BIGINT_LIMB_BITS;
+    NumberKernel::Limbs result(this->magnitude.size() + words + 1, 0);
+    for (size_t i = 0; i < this->magnitude.size(); i++)
+    {
+        result[i + words] |= this->magnitude[i] << bits;
+        if (bits > 0)
+        {
+            result[i + words + 1] = this->magnitude[i] >> (BIGINT_LIMB_BITS - bits);
+        }
+    }
+    return fromMagnitude(result, this->isNegative);
+}
+
+BigInt BigInt::operator >> (size_t shift) const
+{
+    size_t words = shift / BIGINT_LIMB_BITS;
+    unsigned int bits = shift % BIGINT_LIMB_BITS;
+    if (words >= this->magnitude.size())
+    {
+        return this->isNegative ? BigInt(-1) : BigInt();
+    }
+    // Bits shifted out of a negative value round the magnitude up
+    bool isInexact = bits > 0 && (this->magnitude[words] & ((1u << bits) - 1)) != 0;
+    for (size_t i = 0; i < words && isInexact == false; i++)
+    {
+        isInexact = this->magnitude[i] != 0;
+    }
+    NumberKernel::Limbs result(this->magnitude.size() - words);
+    for (size_t i = 0; i < result.size(); i++)
+    {
+        result[i] = this->magnitude[i + words] >> bits;
+        if (bits > 0 && i + words + 1 < this->magnitude.size())
+        {
+            result[i] |= this->magnitude[i + words + 1] << (BIGINT_LIMB_BITS - bits);
+        }
+    }
+    if (this->isNegative && isInexact)
+    {
+        result = NumberKernel::add(result, NumberKernel::Limbs(1, 1), BIGINT_BASE);
+    }
+    return fromMagnitude(result, this->isNegative);
+}
+
+size_t BigInt::bitLength() const
+{
+    if (this->magnitude.size() == 0)
+    {
+        return 0;
+    }
+    size_t result = (this->magnitude.size() - 1) * BIGINT_LIMB_BITS;
+    for (uint32_t top = this->magnitude.back(); top != 0; top >>= 1)
+    {
+        result++;
+    }
+    return result;
+}
+
+BigInt::operator int64_t() const
+{
+    uint64_t word;
+    if (NumberKernel::toWord(this->magnitude, BIGINT_BASE, &word) == false)
+    {
+        return this->isNegative ? INT64_MIN : INT64_MAX;
+    }
+    if (this->isNegative)
+    {
+        return word > (uint64_t)INT64_MAX + 1 ? INT64_MIN : (int64_t)(0 - word);
+    }
+    return word > (uint64_t)INT64_MAX ? INT64_MAX : (int64_t)word;
+}
+
+BigInt::operator double() const
+{
+    double result = 0;
+    for (size_t i = this->magnitude.size(); i-- > 0;)
+    {
+        result = result * (double)BIGINT_BASE + this->magnitude[i];
+    }
+    return this->isNegative ? -result : result;
+}
+
+BigInt::operator Number() const
+{
+    return Number::fromLimbs(NumberKernel::convert(this->magnitude, BIGINT_BASE, LIMB_BASE), 0, this->isNegative, DEFAULT_LENGTH);
+}
+
+BigInt::operator std::string() const
+{
+    return this->toString(10);
+}
+
+std::string BigInt::toString(unsigned int base, bool isUpperCase) const
+{
+    if (base < 2 || base > 36)
+    {
+        throw std::domain_error("BigInt: base must be in [2, 36]");
+    }
+    const char* symbols = isUpperCase ? "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ" : "0123456789abcdefghijklmnopqrstuvwxyz";
+    // Digits from the lowest one
+    std::string result;
+    if ((base & (base - 1)) == 0)
+    {
+        // A power of two base is read bit by bit from the limbs
+        int bits = 0;
+        while ((1u << bits) < base)
+        {
+            bits++;
+        }
+        size_t totalBits = this->magnitude.size() * BIGINT_LIMB_BITS;
+        for (size_t position = 0; position < totalBits; position += bits)
+        {
+            unsigned int digit = 0;
+            for (int i = 0; i < bits && position + i < totalBits; i++)
+            {
+                digit |= ((this->magnitude[(position + i) / BIGINT_LIMB_BITS] >> ((position + i) % BIGINT_LIMB_BITS)) & 1) << i;
+            }
+            result += symbols[digit];
+        }
+    }
+    else
+    {
+        size_t digits;
+        uint64_t limbBase = radixLimb(base, &digits);
+        NumberKernel::Limbs limbs = NumberKernel::convert(this->magnitude, BIGINT_BASE, limbBase);
+        result.reserve(limbs.size() * digits + 1);
+        for (uint32_t limb : limbs)
+        {
+            for (size_t i = 0; i < digits; i++)
+            {
+                result += symbols[limb % base];
+                limb /= base;
+            }
+        }
+    }
+    while (result.size() > 1 && result.back() == '0')
+    {
+        result.pop_back();
+    }
+    if (result.size() == 0)
+    {
+        result = "0";
+    }
+    if (this->isNegative)
+    {
+        result += '-';
+    }
+    return std::string(result.rbegin(), result.rend());
+}
+
+bool BigInt::fromString(const std::string& text, unsigned int base, BigInt& result)
+{
+    if (base < 2 || base > 36)
+    {
+        return false;
+    }
+    size_t first = 0;
+    bool isNegative = false;
+    if (text.size() > 0 && (text[0] == '-' || text[0] == '+'))
+    {
+        isNegative = text[0] == '-';
+        first = 1;
+    }
+    if (first >= text.size())
+    {
+        return false;
+    }
+    // Digit values from the lowest one
+    std::vector<uint32_t> values(text.size() - first);
+    for (size_t i = first; i < text.size(); i++)
+    {
+        char c = text[i];
+        unsigned int value = 36;
+        if (c >= '0' && c <= '9')
+        {
+            value = c - '0';
+        }
+        else if (c >= 'a' && c <= 'z')
+        {
+            value = c - 'a' + 10;
+        }
+        else if (c >= 'A' && c <= 'Z')
+        {
+            value = c - 'A' + 10;
+        }
+        if (value >= base)
+        {
+            return false;
+        }
+        values[text.size() - 1 - i] = value;
+    }
+    size_t digits;
+    uint64_t limbBase = radixLimb(base, &digits);
+    NumberKernel::Limbs limbs((values.size() + digits - 1) / digits, 0);
+    for (size_t i = limbs.size() * digits; i-- > 0;)
+    {
+        limbs[i / digits] = limbs[i / digits] * base + (i < values.size() ? values[i] : 0);
+    }
+    NumberKernel::trim(limbs);
+    result = fromMagnitude(NumberKernel::convert(limbs, limbBase, BIGINT_BASE), isNegative);
+    return true;
+}
+
+std::vector<unsigned char> BigInt::toBytes(bool isBigEndian) const
+{
+    std::vector<unsigned char> result(this->magnitude.size() * 4);
+    for (size_t i = 0; i < result.size(); i++)
+    {
+        result[i] = (unsigned char)(this->magnitude[i / 4] >> (8 * (i % 4)));
+    }
+    while (result.size() > 0 && result.back() == 0)
+    {
+        result.pop_back();
+    }
+    if (isBigEndian)
+    {
+        std::reverse(result.begin(), result.end());
+    }
+    return result;
+}
+
+BigInt BigInt::fromBytes(const unsigned char* data, size_t size, bool isBigEndian)
+{
+    NumberKernel::Limbs limbs((size + 3) / 4, 0);
+    for (size_t i = 0; i < size; i++)
+    {
+        // Byte i from the lowest one
+        unsigned char byte = isBigEndian ? data[size - 1 - i] : data[i];
+        limbs[i / 4] |= (uint32_t)byte << (8 * (i % 4));
+    }
+    return fromMagnitude(limbs, false);
+}
+
+BigInt BigInt::gcd(const BigInt& a, const BigInt& b)
+{
+    return fromMagnitude(NumberKernel::gcd(a.magnitude, b.magnitude, BIGINT_BASE), false);
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "Number.h"
+
+// BigInt magnitudes are binary limbs
+#define BIGINT_LIMB_BITS 32
+#define BIGINT_BASE 4294967296ULL
+
+// Arbitrary-precision integer sharing the NumberKernel algorithms with Number
+// It only stores a sign and base 2^32 limbs, without the decimal part, decimalLength and the cached hash of Number
+// Shifts and bitwise operations work on the limbs directly, negative values behave like infinite two's complement
+class BigInt
+{
+private:
+    enum BitOperation
+    {
+        AND,
+        OR,
+        XOR
+    };
+
+    bool isNegative;
+    // little-endian limbs without zero limbs at the end, zero is empty and always positive
+    NumberKernel::Limbs magnitude;
+
+    // Build from any limbs, remove the zero limbs at the end and make zero positive
+    static BigInt fromMagnitude(NumberKernel::Limbs magnitude, bool isNegative);
+    // Multiply magnitudes, long ones are split into 16-bit limbs so that the kernel can use NTT
+    static NumberKernel::Limbs multiplyMagnitudes(const NumberKernel::Limbs& a, const NumberKernel::Limbs& b);
+    // Two's complement in size limbs, size must be greater than the number of limbs of the magnitude
+    NumberKernel::Limbs toTwosComplement(size_t size) const;
+    static BigInt fromTwosComplement(NumberKernel::Limbs limbs);
+    static BigInt bitwise(const BigInt& a, const BigInt& b, BitOperation operation);
+    // Compare the values, return -1, 0 or 1
+    static int compare(const BigInt& a, const BigInt& b);
+
+public:
+    BigInt();
+    BigInt(int64_t n);
+    // Decimal digits with an optional sign, throw std::domain_error if the text is not an integer
+    explicit BigInt(const std::string& n);
+    // The decimal part is truncated
+    explicit BigInt(const Number& n);
+
+    BigInt operator - () const;
+    BigInt operator + (const BigInt& n) const;
+    BigInt operator - (const BigInt& n) const;
+    BigInt operator * (const BigInt& n) const;
+    // Truncated division like Number, throw std::domain_error if n is zero
+    BigInt operator / (const BigInt& n) const;
+    // Remainder of the truncated division, it has the same sign as *this, throw std::domain_error if n is zero
+    BigInt operator % (const BigInt& n) const;
+    bool operator == (const BigInt& n) const;
+    bool operator != (const BigInt& n) const;
+    bool operator < (const BigInt& n) const;
+    bool operator > (const BigInt& n) const;
+    bool operator <= (const BigInt& n) const;
+    bool operator >= (const BigInt& n) const;
+
+    // Bitwise operations on the two's complement, ~n equals -n - 1
+    BigInt operator ~ () const;
+    BigInt operator & (const BigInt& n) const;
+    BigInt operator | (const BigInt& n) const;
+    BigInt operator ^ (const BigInt& n) const;
+    // Multiply by 2^shift
+    BigInt operator << (size_t shift) const;
+    // Divide by 2^shift rounding toward negative infinity, so -1 >> 1 is -1
+    BigInt operator >> (size_t shift) const;
+    // Number of bits of the magnitude, 0 for zero
+    size_t bitLength() const;
+
+    // Values out of range are clamped to INT64_MIN or INT64_MAX
+    explicit operator int64_t() const;
+    explicit operator double() const;
+    explicit operator Number() const;
+    operator std::string() const;
+
+    // Digits in base 2 to 36 with a leading '-' if negative, throw std::domain_error if the base is invalid
+    std::string toString(unsigned int base, bool isUpperCase = false) const;
+    // Parse digits in base 2 to 36 with an optional sign, letters are not case-sensitive, return false if the text or the base is invalid
+    static bool fromString(const std::string& text, unsigned int base, BigInt& result);
+    // Magnitude as bytes without leading zero bytes, zero gives no bytes
+    std::vector<unsigned char> toBytes(bool isBigEndian = true) const;
+    // Non-negative integer from a byte array
+    static BigInt fromBytes(const unsigned char* data, size_t size, bool isBigEndian = true);
+
+    // Greatest common divisor, always non-negative
+    static BigInt gcd(const BigInt& a, const BigInt& b);
+};
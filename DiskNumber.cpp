@@ -0,0 +1,632 @@
+#include "DiskNumber.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+size_t DiskNumber::memoryBudget = DISK_NUMBER_DEFAULT_BUDGET;
+std::string DiskNumber::temporaryDirectory = "";
+static std::atomic<uint64_t> temporaryCounter(0);
+
+static uint32_t loadLimb(const unsigned char* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+
+static void storeLimb(unsigned char* p, uint32_t limb)
+{
+    p[0] = (unsigned char)(limb & 0xFF);
+    p[1] = (unsigned char)(limb >> 8);
+}
+
+DiskNumber DiskNumber::createTemporary(uint64_t length)
+{
+    std::filesystem::path directory = temporaryDirectory.size() > 0 ? std::filesystem::path(temporaryDirectory) : std::filesystem::temp_directory_path();
+    uint64_t stamp = (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+    std::string name = "DiskNumber-" + std::to_string(stamp) + "-" + std::to_string(temporaryCounter++) + ".limbs";
+    DiskNumber result;
+    result.path = (directory / name).string();
+    result.isTemporary = true;
+    std::ofstream file(result.path, std::ios::binary | std::ios::trunc);
+    if (file.is_open() == false)
+    {
+        throw std::runtime_error("DiskNumber: cannot create " + result.path);
+    }
+    file.close();
+    result.resize(length);
+    return result;
+}
+
+size_t DiskNumber::chunkLimbs()
+{
+    // Three windows of 2 bytes per limb, plus some room for the system
+    return std::max((size_t)4096, memoryBudget / 8);
+}
+
+void DiskNumber::map(MappedFile& window, uint64_t first, size_t count, bool writable) const
+{
+    if (window.open(this->path, first * 2, count * 2, writable) == false)
+    {
+        throw std::runtime_error("DiskNumber: cannot map " + this->path);
+    }
+}
+
+NumberKernel::Limbs DiskNumber::load(uint64_t first, size_t count) const
+{
+    NumberKernel::Limbs result(count, 0);
+    MappedFile window;
+    this->map(window, first, count, false);
+    const unsigned char* p = window.data();
+    for (size_t i = 0; i < count; i++)
+    {
+        result[i] = loadLimb(p + i * 2);
+    }
+    return result;
+}
+
+void DiskNumber::addAt(uint64_t offset, const NumberKernel::Limbs& limbs)
+{
+    size_t chunk = chunkLimbs();
+    uint32_t carry = 0;
+    size_t i = 0;
+    uint64_t position = offset;
+    while ((i < limbs.size() || carry > 0) && position < this->length)
+    {
+        // Once all limbs are added, only a short window is needed to finish the carry
+        size_t count = (size_t)std::min<uint64_t>(chunk, this->length - position);
+        count = i < limbs.size() ? std::min(count, limbs.size() - i) : std::min(count, (size_t)4096);
+        MappedFile window;
+        this->map(window, position, count, true);
+        unsigned char* p = window.data();
+        for (size_t k = 0; k < count; k++, i++)
+        {
+            uint32_t x = loadLimb(p + k * 2) + (i < limbs.size() ? limbs[i] : 0) + carry;
+            carry = x >= LIMB_BASE ? 1 : 0;
+            storeLimb(p + k * 2, x - carry * LIMB_BASE);
+        }
+        position += count;
+    }
+}
+
+void DiskNumber::resize(uint64_t length)
+{
+    std::error_code error;
+    std::filesystem::resize_file(this->path, length * 2, error);
+    if (error)
+    {
+        throw std::runtime_error("DiskNumber: cannot resize " + this->path);
+    }
+    this->length = length;
+}
+
+uint64_t DiskNumber::significantLength() const
+{
+    size_t chunk = chunkLimbs();
+    uint64_t end = this->length;
+    while (end > 0)
+    {
+        size_t count = (size_t)std::min<uint64_t>(chunk, end);
+        MappedFile window;
+        this->map(window, end - count, count, false);
+        const unsigned char* p = window.data();
+        for (size_t k = count; k > 0; k--)
+        {
+            if (loadLimb(p + (k - 1) * 2) != 0)
+            {
+                return end - count + k;
+            }
+        }
+        end -= count;
+    }
+    return 0;
+}
+
+void DiskNumber::trim()
+{
+    uint64_t length = this->significantLength();
+    if (length != this->length)
+    {
+        this->resize(length);
+    }
+}
+
+DiskNumber DiskNumber::addMagnitude(const DiskNumber& a, const DiskNumber& b)
+{
+    uint64_t n = std::max(a.length, b.length) + 1;
+    DiskNumber result = createTemporary(n);
+    size_t chunk = chunkLimbs();
+    uint32_t carry = 0;
+    for (uint64_t start = 0; start < n; start += chunk)
+    {
+        size_t count = (size_t)std::min<uint64_t>(chunk, n - start);
+        size_t countA = start < a.length ? (size_t)std::min<uint64_t>(count, a.length - start) : 0;
+        size_t countB = start < b.length ? (size_t)std::min<uint64_t>(count, b.length - start) : 0;
+        MappedFile windowR;
+        MappedFile windowA;
+        MappedFile windowB;
+        result.map(windowR, start, count, true);
+        if (countA > 0)
+        {
+            a.map(windowA, start, countA, false);
+        }
+        if (countB > 0)
+        {
+            b.map(windowB, start, countB, false);
+        }
+        unsigned char* r = windowR.data();
+        for (size_t k = 0; k < count; k++)
+        {
+            uint32_t x = carry;
+            x += k < countA ? loadLimb(windowA.data() + k * 2) : 0;
+            x += k < countB ? loadLimb(windowB.data() + k * 2) : 0;
+            carry = x >= LIMB_BASE ? 1 : 0;
+            storeLimb(r + k * 2, x - carry * LIMB_BASE);
+        }
+    }
+    result.trim();
+    return result;
+}
+
+DiskNumber DiskNumber::subtractMagnitude(const DiskNumber& a, const DiskNumber& b)
+{
+    uint64_t n = a.length;
+    DiskNumber result = createTemporary(n);
+    size_t chunk = chunkLimbs();
+    uint32_t borrow = 0;
+    for (uint64_t start = 0; start < n; start += chunk)
+    {
+        size_t count = (size_t)std::min<uint64_t>(chunk, n - start);
+        size_t countB = start < b.length ? (size_t)std::min<uint64_t>(count, b.length - start) : 0;
+        MappedFile windowR;
+        MappedFile windowA;
+        MappedFile windowB;
+        result.map(windowR, start, count, true);
+        a.map(windowA, start, count, false);
+        if (countB > 0)
+        {
+            b.map(windowB, start, countB, false);
+        }
+        unsigned char* r = windowR.data();
+        for (size_t k = 0; k < count; k++)
+        {
+            uint32_t x = loadLimb(windowA.data() + k * 2);
+            uint32_t y = (k < countB ? loadLimb(windowB.data() + k * 2) : 0) + borrow;
+            borrow = x < y ? 1 : 0;
+            storeLimb(r + k * 2, x + borrow * LIMB_BASE - y);
+        }
+    }
+    result.trim();
+    return result;
+}
+
+int DiskNumber::compareMagnitude(const DiskNumber& a, const DiskNumber& b)
+{
+    if (a.length != b.length)
+    {
+        return a.length < b.length ? -1 : 1;
+    }
+    size_t chunk = chunkLimbs();
+    uint64_t end = a.length;
+    while (end > 0)
+    {
+        size_t count = (size_t)std::min<uint64_t>(chunk, end);
+        MappedFile windowA;
+        MappedFile windowB;
+        a.map(windowA, end - count, count, false);
+        b.map(windowB, end - count, count, false);
+        for (size_t k = count; k > 0; k--)
+        {
+            uint32_t x = loadLimb(windowA.data() + (k - 1) * 2);
+            uint32_t y = loadLimb(windowB.data() + (k - 1) * 2);
+            if (x != y)
+            {
+                return x < y ? -1 : 1;
+            }
+        }
+        end -= count;
+    }
+    return 0;
+}
+
+DiskNumber DiskNumber::addSigned(const DiskNumber& a, const DiskNumber& b, bool bIsNegative)
+{
+    DiskNumber result;
+    if (a.isNegative == bIsNegative)
+    {
+        result = addMagnitude(a, b);
+        result.isNegative = a.isNegative;
+    }
+    else if (compareMagnitude(a, b) >= 0)
+    {
+        result = subtractMagnitude(a, b);
+        result.isNegative = a.isNegative;
+    }
+    else
+    {
+        result = subtractMagnitude(b, a);
+        result.isNegative = bIsNegative;
+    }
+    if (result.length == 0)
+    {
+        result.isNegative = false;
+    }
+    return result;
+}
+
+int DiskNumber::compare(const DiskNumber& a, const DiskNumber& b)
+{
+    bool aIsNegative = a.isNegative && a.length > 0;
+    bool bIsNegative = b.isNegative && b.length > 0;
+    if (aIsNegative != bIsNegative)
+    {
+        return aIsNegative ? -1 : 1;
+    }
+    int result = compareMagnitude(a, b);
+    return aIsNegative ? -result : result;
+}
+
+DiskNumber::DiskNumber()
+{
+    this->isNegative = false;
+    this->length = 0;
+    this->isTemporary = false;
+}
+
+DiskNumber::DiskNumber(const std::string& path, bool isNegative)
+{
+    std::error_code error;
+    uint64_t size = std::filesystem::file_size(path, error);
+    if (error)
+    {
+        throw std::runtime_error("DiskNumber: cannot open " + path);
+    }
+    this->path = path;
+    this->isNegative = isNegative;
+    this->length = size / 2;
+    this->isTemporary = false;
+    this->length = this->significantLength();
+}
+
+DiskNumber::DiskNumber(DiskNumber&& n)
+{
+    this->path = std::move(n.path);
+    this->isNegative = n.isNegative;
+    this->length = n.length;
+    this->isTemporary = n.isTemporary;
+    n.path.clear();
+    n.length = 0;
+    n.isTemporary = false;
+}
+
+DiskNumber& DiskNumber::operator = (DiskNumber&& n)
+{
+    if (this != &n)
+    {
+        if (this->isTemporary)
+        {
+            std::error_code error;
+            std::filesystem::remove(this->path, error);
+        }
+        this->path = std::move(n.path);
+        this->isNegative = n.isNegative;
+        this->length = n.length;
+        this->isTemporary = n.isTemporary;
+        n.path.clear();
+        n.length = 0;
+        n.isTemporary = false;
+    }
+    return *this;
+}
+
+DiskNumber::~DiskNumber()
+{
+    if (this->isTemporary)
+    {
+        std::error_code error;
+        std::filesystem::remove(this->path, error);
+    }
+}
+
+DiskNumber DiskNumber::fromNumber(const Number& n)
+{
+    size_t limbCount = (n.primary.size() + LIMB_DIGITS - 1) / LIMB_DIGITS;
+    DiskNumber result = createTemporary(limbCount);
+    if (limbCount > 0)
+    {
+        MappedFile window;
+        result.map(window, 0, limbCount, true);
+        unsigned char* p = window.data();
+        // Pack the integer digits from the lowest one
+        for (size_t k = 0; k < limbCount; k++)
+        {
+            uint32_t limb = 0;
+            for (size_t d = LIMB_DIGITS; d > 0; d--)
+            {
+                size_t index = k * LIMB_DIGITS + d;
+                limb = limb * 10 + (index <= n.primary.size() ? n.primary[n.primary.size() - index] : 0);
+            }
+            storeLimb(p + k * 2, limb);
+        }
+    }
+    result.trim();
+    result.isNegative = n.isNegative && result.length > 0;
+    return result;
+}
+
+DiskNumber DiskNumber::fromText(const std::string& textPath)
+{
+    std::error_code error;
+    uint64_t size = std::filesystem::file_size(textPath, error);
+    if (error)
+    {
+        throw std::runtime_error("DiskNumber: cannot open " + textPath);
+    }
+    DiskNumber result = createTemporary(0);
+    std::ofstream output(result.path, std::ios::binary | std::ios::trunc);
+    size_t chunk = chunkLimbs();
+    // The sign found so far, the text is read backwards so any digit after it comes before it in the text
+    char sign = '\0';
+
+    // Walk the text backwards so that the lowest limb is produced first
+    std::string buffer;
+    uint64_t limbCount = 0;
+    uint32_t limb = 0;
+    uint32_t power = 1;
+    uint64_t end = size;
+    while (end > 0)
+    {
+        size_t count = (size_t)std::min<uint64_t>(chunk, end);
+        MappedFile window;
+        if (window.open(textPath, end - count, count, false) == false)
+        {
+            throw std::runtime_error("DiskNumber: cannot map " + textPath);
+        }
+        const unsigned char* text = window.data();
+        for (size_t k = count; k > 0; k--)
+        {
+            unsigned char c = text[k - 1];
+            if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+            {
+                continue;
+            }
+            if ((c == '-' || c == '+') && sign == '\0')
+            {
+                sign = (char)c;
+                continue;
+            }
+            if (c < '0' || c > '9' || sign != '\0')
+            {
+                throw std::runtime_error("DiskNumber: invalid character in " + textPath);
+            }
+            limb += (c - '0') * power;
+            power *= 10;
+            if (power == LIMB_BASE)
+            {
+                buffer += (char)(limb & 0xFF);
+                buffer += (char)(limb >> 8);
+                limbCount++;
+                limb = 0;
+                power = 1;
+            }
+        }
+        if (buffer.size() >= chunk)
+        {
+            output.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+        end -= count;
+    }
+    if (power > 1)
+    {
+        buffer += (char)(limb & 0xFF);
+        buffer += (char)(limb >> 8);
+        limbCount++;
+    }
+    output.write(buffer.data(), buffer.size());
+    output.close();
+    if (output.fail())
+    {
+        throw std::runtime_error("DiskNumber: cannot write " + result.path);
+    }
+    result.length = limbCount;
+    result.trim();
+    result.isNegative = sign == '-' && result.length > 0;
+    return result;
+}
+
+DiskNumber DiskNumber::operator + (const DiskNumber& n) const
+{
+    return addSigned(*this, n, n.isNegative);
+}
+
+DiskNumber DiskNumber::operator - (const DiskNumber& n) const
+{
+    return addSigned(*this, n, !n.isNegative);
+}
+
+DiskNumber DiskNumber::operator * (const DiskNumber& n) const
+{
+    if (this->length == 0 || n.length == 0)
+    {
+        return DiskNumber();
+    }
+    DiskNumber result = createTemporary(this->length + n.length);
+    // A block product and the NTT buffers take about 64 bytes per block limb
+    size_t block = std::max((size_t)1024, memoryBudget / 128);
+    for (uint64_t i = 0; i < this->length; i += block)
+    {
+        NumberKernel::Limbs a = this->load(i, (size_t)std::min<uint64_t>(block, this->length - i));
+        NumberKernel::trim(a);
+        for (uint64_t j = 0; j < n.length; j += block)
+        {
+            NumberKernel::Limbs b = n.load(j, (size_t)std::min<uint64_t>(block, n.length - j));
+            NumberKernel::trim(b);
+            result.addAt(i + j, NumberKernel::multiply(a, b, LIMB_BASE));
+        }
+    }
+    result.trim();
+    result.isNegative = (this->isNegative != n.isNegative);
+    return result;
+}
+
+bool DiskNumber::operator == (const DiskNumber& n) const
+{
+    return compare(*this, n) == 0;
+}
+
+bool DiskNumber::operator != (const DiskNumber& n) const
+{
+    return compare(*this, n) != 0;
+}
+
+bool DiskNumber::operator < (const DiskNumber& n) const
+{
+    return compare(*this, n) < 0;
+}
+
+bool DiskNumber::operator > (const DiskNumber& n) const
+{
+    return compare(*this, n) > 0;
+}
+
+bool DiskNumber::operator <= (const DiskNumber& n) const
+{
+    return compare(*this, n) <= 0;
+}
+
+bool DiskNumber::operator >= (const DiskNumber& n) const
+{
+    return compare(*this, n) >= 0;
+}
+
+void DiskNumber::negate()
+{
+    this->isNegative = (!this->isNegative) && this->length > 0;
+}
+
+Number DiskNumber::toNumber() const
+{
+    NumberKernel::Limbs limbs;
+    if (this->length > 0)
+    {
+        limbs = this->load(0, (size_t)this->length);
+    }
+    return Number::fromLimbs(limbs, 0, this->isNegative, DEFAULT_LENGTH);
+}
+
+bool DiskNumber::write(std::ostream& output) const
+{
+    if (this->length == 0)
+    {
+        output << '0';
+        return output.good();
+    }
+    if (this->isNegative)
+    {
+        output << '-';
+    }
+    size_t chunk = chunkLimbs();
+    std::string buffer;
+    bool isLeading = true;
+    uint64_t end = this->length;
+    while (end > 0)
+    {
+        size_t count = (size_t)std::min<uint64_t>(chunk, end);
+        MappedFile window;
+        this->map(window, end - count, count, false);
+        const unsigned char* p = window.data();
+        buffer.clear();
+        for (size_t k = count; k > 0; k--)
+        {
+            uint32_t limb = loadLimb(p + (k - 1) * 2);
+            for (uint32_t power = LIMB_BASE / 10; power > 0; power /= 10)
+            {
+                char c = (char)('0' + limb / power % 10);
+                // Skip the leading zeros of the highest limb
+                if (isLeading && c == '0')
+                {
+                    continue;
+                }
+                isLeading = false;
+                buffer += c;
+            }
+        }
+        output.write(buffer.data(), buffer.size());
+        end -= count;
+    }
+    return output.good();
+}
+
+uint64_t DiskNumber::digits() const
+{
+    if (this->length == 0)
+    {
+        return 1;
+    }
+    uint32_t top = this->load(this->length - 1, 1)[0];
+    uint64_t result = (this->length - 1) * LIMB_DIGITS;
+    while (top > 0)
+    {
+        result++;
+        top /= 10;
+    }
+    return result;
+}
+
+const std::string& DiskNumber::getPath() const
+{
+    return this->path;
+}
+
+bool DiskNumber::save(const std::string& path)
+{
+    std::error_code error;
+    if (this->path.size() == 0)
+    {
+        // Zero without a file
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (file.is_open() == false)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        std::filesystem::rename(this->path, path, error);
+        if (error)
+        {
+            // Different file systems, copy the file instead
+            error.clear();
+            std::filesystem::copy_file(this->path, path, std::filesystem::copy_options::overwrite_existing, error);
+            if (error)
+            {
+                return false;
+            }
+            if (this->isTemporary)
+            {
+                std::filesystem::remove(this->path, error);
+            }
+        }
+    }
+    this->path = path;
+    this->isTemporary = false;
+    return true;
+}
+
+void DiskNumber::setMemoryBudget(size_t bytes)
+{
+    memoryBudget = std::max(bytes, (size_t)1048576);
+}
+
+size_t DiskNumber::getMemoryBudget()
+{
+    return memoryBudget;
+}
+
+void DiskNumber::setTemporaryDirectory(const std::string& directory)
+{
+    temporaryDirectory = directory;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <string>
+#include <ostream>
+#include <cstdint>
+#include "Number.h"
+#include "MappedFile.h"
+
+// Default working set of a single DiskNumber operation, 256 MiB
+#define DISK_NUMBER_DEFAULT_BUDGET 268435456
+
+// Out-of-core integer for values that do not fit in memory
+// Digits are stored as base 10000 limbs in a file, 2 bytes per limb (little-endian), the lowest limb first
+// The file only holds the magnitude, the sign is kept in the instance
+// Operations read and write the files through memory mapped windows, so the working set is bounded by the memory budget
+// Results are stored in temporary files which are deleted with the instance, call save() to keep them
+// Throw std::runtime_error if a file cannot be created, mapped or resized
+class DiskNumber
+{
+private:
+    std::string path;
+    bool isNegative;
+    // number of limbs, the highest limb is never zero
+    uint64_t length;
+    // delete the file when the instance is destroyed
+    bool isTemporary;
+
+    static size_t memoryBudget;
+    static std::string temporaryDirectory;
+
+    // Create an empty limb file with a unique name in the temporary directory
+    static DiskNumber createTemporary(uint64_t length);
+    // Number of limbs processed at once by streaming operations
+    static size_t chunkLimbs();
+    // Map limbs [first, first + count) of the file
+    void map(MappedFile& window, uint64_t first, size_t count, bool writable) const;
+    // Read limbs [first, first + count) into memory
+    NumberKernel::Limbs load(uint64_t first, size_t count) const;
+    // Add limbs to the file starting at limb offset, the file must be long enough to hold the carry
+    void addAt(uint64_t offset, const NumberKernel::Limbs& limbs);
+    // Resize the file to the given number of limbs
+    void resize(uint64_t length);
+    // Number of limbs without the zero limbs at the top of the file
+    uint64_t significantLength() const;
+    // Drop zero limbs at the top and shrink the file
+    void trim();
+    // |a| + |b|
+    static DiskNumber addMagnitude(const DiskNumber& a, const DiskNumber& b);
+    // |a| - |b|, |a| must not be less than |b|
+    static DiskNumber subtractMagnitude(const DiskNumber& a, const DiskNumber& b);
+    // Compare |a| and |b|, return -1, 0 or 1
+    static int compareMagnitude(const DiskNumber& a, const DiskNumber& b);
+    // a + b, but use bIsNegative as the sign of b
+    static DiskNumber addSigned(const DiskNumber& a, const DiskNumber& b, bool bIsNegative);
+    // Compare a and b, return -1, 0 or 1
+    static int compare(const DiskNumber& a, const DiskNumber& b);
+
+public:
+    // Zero, no file is created until it is needed
+    DiskNumber();
+    // Use an existing limb file, the file will not be deleted with the instance
+    DiskNumber(const std::string& path, bool isNegative = false);
+    DiskNumber(DiskNumber&& n);
+    DiskNumber& operator = (DiskNumber&& n);
+    DiskNumber(const DiskNumber&) = delete;
+    DiskNumber& operator = (const DiskNumber&) = delete;
+    // Delete the file if it is temporary
+    ~DiskNumber();
+
+    // Store the integer part of n
+    static DiskNumber fromNumber(const Number& n);
+    // Parse a decimal integer text file chunk by chunk, an optional leading '-' or '+' and whitespace are accepted
+    // Throw std::runtime_error if the file cannot be read or has any other character, such as a decimal point
+    static DiskNumber fromText(const std::string& textPath);
+
+    DiskNumber operator + (const DiskNumber& n) const;
+    DiskNumber operator - (const DiskNumber& n) const;
+    // Multiply block by block, each pair of blocks is multiplied in memory with the Number kernels
+    DiskNumber operator * (const DiskNumber& n) const;
+    bool operator == (const DiskNumber& n) const;
+    bool operator != (const DiskNumber& n) const;
+    bool operator < (const DiskNumber& n) const;
+    bool operator > (const DiskNumber& n) const;
+    bool operator <= (const DiskNumber& n) const;
+    bool operator >= (const DiskNumber& n) const;
+    // Flip the sign in place
+    void negate();
+
+    // Load the whole value into memory
+    Number toNumber() const;
+    // Write the decimal digits to the stream chunk by chunk, return false if writing failed
+    bool write(std::ostream& output) const;
+    // Number of decimal digits
+    uint64_t digits() const;
+    // Path of the limb file, empty if the value is zero and no file was created
+    const std::string& getPath() const;
+    // Move the limb file to path and keep it after the instance is destroyed, return false if failed
+    bool save(const std::string& path);
+
+    // Limit the memory used by a single operation, the minimum is 1 MiB
+    static void setMemoryBudget(size_t bytes);
+    static size_t getMemoryBudget();
+    // Directory for temporary limb files, use the system temporary directory if empty
+    static void setTemporaryDirectory(const std::string& directory);
+};
@@ -1,17 +1,81 @@
 #include "Display.h"
 
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <memory>
+#include <thread>
+
+// Record of the asynchronous log, the sequence number orders the records of all threads
+struct AsyncRecord
+{
+    uint64_t sequence;
+    std::string text;
+};
+
+// Single-producer single-consumer ring, only the producer thread moves tail and only the writer thread moves head
+struct Display::AsyncQueue
+{
+    std::vector<AsyncRecord> records;
+    std::atomic<size_t> head{ 0 };
+    std::atomic<size_t> tail{ 0 };
+    // set when the producer thread exits or a new session starts, the writer removes the queue once it is empty
+    std::atomic<bool> isClosed{ false };
+};
+
+struct Display::AsyncLog
+{
+    // lock queues, owner and writer, the producers only take it to register their queue or to wake up the writer
+    std::mutex mtx;
+    std::condition_variable condition;
+    std::vector<std::shared_ptr<AsyncQueue>> queues;
+    std::thread writer;
+    // instance which started the asynchronous mode, it prints the records
+    Display* owner = nullptr;
+    std::atomic<bool> isRunning{ false };
+    std::atomic<bool> isStopping{ false };
+    std::atomic<bool> isWriterWaiting{ false };
+    std::atomic<uint64_t> sequence{ 0 };
+    // incremented by every startAsync(), a thread registers a new queue when it changed
+    std::atomic<uint64_t> generation{ 0 };
+    std::atomic<size_t> dropped{ 0 };
+    size_t capacity = DISPLAY_ASYNC_QUEUE_SIZE;
+    bool isDropping = false;
+};
+
 std::mutex Display::mtx;
 COORD Display::cursorPosition = { 0, 0 };
+bool Display::isCursorExact = false;
+COORD Display::consoleSize = { 0, 0 };
 std::string Display::cursorColor = "r";
 size_t Display::specialCharCursor = 0;
+std::string Display::outputBuffer;
+std::mutex Display::outputMtx;
+thread_local size_t Display::outputDepth = 0;
+Display::AsyncLog Display::asyncLog;
+
+Display::OutputScope::OutputScope()
+{
+    outputDepth++;
+}
+
+Display::OutputScope::~OutputScope()
+{
+    outputDepth--;
+    if (outputDepth == 0)
+    {
+        flushOutput();
+    }
+}
 
 char Display::c()
 {
+    // Show everything before waiting for the input
+    flushOutput();
     std::lock_guard<std::mutex> lock(mtx);
 #ifdef _WIN32
     return (char)_getch();
 #else
-    std::cout.flush();
     char buf = 0;
     termios old = {};
     if (tcgetattr(STDIN_FILENO, &old) < 0)
@@ -37,16 +101,86 @@ char Display::c()
 #endif
 }
 
+void Display::output(const char* data, size_t size)
+{
+    bool isFull = false;
+    {
+        std::lock_guard<std::mutex> lock(outputMtx);
+        outputBuffer.append(data, size);
+        isFull = outputBuffer.size() >= DISPLAY_OUTPUT_BUFFER_SIZE;
+    }
+    if (isFull)
+    {
+        flushOutput();
+    }
+}
+
+void Display::output(const std::string& text)
+{
+    output(text.data(), text.size());
+}
+
+void Display::output(char c)
+{
+    output(&c, 1);
+}
+
+void Display::flushOutput()
+{
+    std::lock_guard<std::mutex> lock(outputMtx);
+    if (outputBuffer.size() == 0)
+    {
+        return;
+    }
+    // Text the caller printed with std::cout goes first
+    std::cout.flush();
+#ifdef _WIN32
+    std::cout.write(outputBuffer.data(), outputBuffer.size());
+    std::cout.flush();
+#else
+    size_t written = 0;
+    while (written < outputBuffer.size())
+    {
+        ssize_t result = write(STDOUT_FILENO, outputBuffer.data() + written, outputBuffer.size() - written);
+        if (result < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        written += (size_t)result;
+    }
+#endif
+    outputBuffer.clear();
+}
+
 void Display::changeCursor(char c)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    moveCursor(c);
+}
+
+void Display::moveCursor(char c)
 {
     // Note: This functions is platform-independent, but it may not be accurate
     // Warning: Unknown Characters may exist
-    std::lock_guard<std::mutex> lock(mtx);
+    // The width of unicode characters and the effect of other control characters are guessed, relative moves are not safe after them
+    if (c < 0 || (c < 32 && c != '\n' && c != '\r' && c != '\b' && c != '\t' && c != '\0') || c == 127 || (c == '\b' && cursorPosition.X == 0))
+    {
+        isCursorExact = false;
+    }
     if (c == '\n')
     {
         specialCharCursor = 0;
         cursorPosition.X = 0;
         cursorPosition.Y++;
+        // A line feed on the last row scrolls the console
+        if (cursorPosition.Y >= consoleSize.Y)
+        {
+            isCursorExact = false;
+        }
     }
     else if (c == '\r')
     {
@@ -93,14 +227,129 @@ void Display::changeCursor(char c)
     {
         specialCharCursor = 0;
     }
+    // Text reaching the last column waits to wrap or wraps to the next line, which is not tracked
+    if (cursorPosition.X >= consoleSize.X)
+    {
+        isCursorExact = false;
+    }
+}
+
+void Display::updateConsoleSize()
+{
+    consoleSize = { 0, 0 };
+#ifdef _WIN32
+    CONSOLE_SCREEN_BUFFER_INFO csbi;
+    if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi))
+    {
+        consoleSize.X = csbi.srWindow.Right - csbi.srWindow.Left + 1;
+        consoleSize.Y = csbi.srWindow.Bottom - csbi.srWindow.Top + 1;
+    }
+#else
+    struct winsize size;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0)
+    {
+        consoleSize.X = (short)size.ws_col;
+        consoleSize.Y = (short)size.ws_row;
+    }
+#endif
+}
+
+void Display::checkCursorExact()
+{
+    if (cursorPosition.X < 0 || cursorPosition.Y < 0 || cursorPosition.X >= consoleSize.X || cursorPosition.Y >= consoleSize.Y)
+    {
+        isCursorExact = false;
+    }
+}
+
+// CSI sequence with one parameter, the parameter is left out when it is the default value 1
+static std::string controlSequence(int parameter, char command)
+{
+    return parameter == 1 ? std::string("\033[") + command : "\033[" + std::to_string(parameter) + command;
+}
+
+std::string Display::cursorMotion(COORD from, COORD to)
+{
+    // Absolute move, the parameters default to 1
+    std::string best = "\033[";
+    if (to.X > 0 || to.Y > 0)
+    {
+        best += std::to_string(to.Y + 1);
+    }
+    if (to.X > 0)
+    {
+        best += ";" + std::to_string(to.X + 1);
+    }
+    best += "H";
+    if (to.X < 0 || to.Y < 0 || from.X < 0 || from.Y < 0)
+    {
+        return best;
+    }
+
+    // Vertical move, a line feed is not used because it scrolls on the last row where CUD stops
+    std::string vertical;
+    int lines = to.Y - from.Y;
+    if (lines > 0)
+    {
+        vertical = controlSequence(lines, 'B');
+    }
+    else if (lines < 0)
+    {
+        vertical = controlSequence(-lines, 'A');
+    }
+
+    // Horizontal moves, the column is kept by the vertical move
+    std::vector<std::string> horizontal;
+    horizontal.push_back(controlSequence(to.X + 1, 'G'));
+    horizontal.push_back(to.X == 0 ? "\r" : "\r" + controlSequence(to.X, 'C'));
+    int columns = to.X - from.X;
+    if (columns == 0)
+    {
+        horizontal.push_back("");
+    }
+    else if (columns > 0)
+    {
+        horizontal.push_back(controlSequence(columns, 'C'));
+    }
+    else
+    {
+        horizontal.push_back(std::string(-columns, '\b'));
+        horizontal.push_back(controlSequence(-columns, 'D'));
+    }
+    for (const std::string& h : horizontal)
+    {
+        if (vertical.size() + h.size() < best.size())
+        {
+            best = vertical + h;
+        }
+    }
+    return best;
 }
 
 void Display::changeCursor(const std::string& text)
+{
+    changeCursor(text.data(), text.size());
+}
+
+void Display::changeCursor(const char* text, size_t size)
 {
     // Warning: This is just a guess, not the actual cursor position
-    for (char c : text)
+    std::lock_guard<std::mutex> lock(mtx);
+    for (size_t i = 0; i < size; i++)
     {
-        changeCursor(c);
+        moveCursor(text[i]);
+    }
+}
+
+void Display::moveCursorRight(size_t columns)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    specialCharCursor = 0;
+    cursorPosition.X += (short)columns;
+    // Same as moveCursor, text reaching the last column wraps in a way that is not tracked
+    if (cursorPosition.X >= consoleSize.X)
+    {
+        isCursorExact = false;
     }
 }
 
@@ -109,6 +358,8 @@ bool Display::updateCursorPosition()
     // Note: GetCursorPosition requires platform-specific code
     // This function is only implemented for windows, for other platforms, it will return false for compatibility
 #ifdef _WIN32
+    // The console only knows the position after the buffered output
+    flushOutput();
     CONSOLE_SCREEN_BUFFER_INFO csbi;
     if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi))
     {
@@ -262,7 +513,7 @@ bool Display::inputIsControlChar(const std::vector<char>& input)
 size_t Display::previewGetInputString(const std::string oClr, const std::string& iStr, size_t cIdx, size_t* lAcuIdx, size_t lVisLen, bool allowClr)
 {
     // Note: "&+ColorCode" will only be displayed when the cursor is near them
-    std::cout << std::string(*lAcuIdx, '\b') << std::string(lVisLen, ' ') << std::string(lVisLen, '\b');
+    output(std::string(*lAcuIdx, '\b') + std::string(lVisLen, ' ') + std::string(lVisLen, '\b'));
     // Show Text
     setTextColor(oClr);
     size_t i = 0;
@@ -284,7 +535,8 @@ size_t Display::previewGetInputString(const std::string oClr, const std::string&
             if (cIdx >= i - 1 && cIdx <= i + 1)
             {
                 // Current Cursor near the color character, force show the color character
-                std::cout << "&" << iStr[i];
+                output('&');
+                output(iStr[i]);
                 visibleLength += 2;
                 if (cIdx == i)
                 {
@@ -298,7 +550,8 @@ size_t Display::previewGetInputString(const std::string oClr, const std::string&
             else if (setColorResult == false)
             {
                 // Failed to match any color, show the original character
-                std::cout << "&" << iStr[i];
+                output('&');
+                output(iStr[i]);
                 visibleLength += 2;
                 if (cIdx == i)
                 {
@@ -315,7 +568,7 @@ size_t Display::previewGetInputString(const std::string oClr, const std::string&
             continue;
         }
 
-        std::cout << iStr[i];
+        output(iStr[i]);
         visibleLength++;
         if (i < cIdx)
         {
@@ -327,7 +580,7 @@ size_t Display::previewGetInputString(const std::string oClr, const std::string&
     // String ending with character '&'
     if (isColorChar)
     {
-        std::cout << "&";
+        output('&');
         visibleLength++;
         if (cIdx == i)
         {
@@ -356,7 +609,7 @@ size_t Display::previewGetInputString(const std::string oClr, const std::string&
     // Set cursor position to originalCursorPosition.X + x
     if (x < visibleLength)
     {
-        std::cout << std::string(visibleLength - x, '\b');
+        output(std::string(visibleLength - x, '\b'));
     }
     *lAcuIdx = x;
     return visibleLength;
@@ -382,7 +635,7 @@ bool Display::printCharToProperPosition(char c, COORD topleft, COORD bottomright
     }
     if (c == '\b')
     {
-        std::cout << '\b';
+        output('\b');
         changeCursor(c);
         updateCursorPosition();
         return true;
@@ -408,7 +661,7 @@ bool Display::printCharToProperPosition(char c, COORD topleft, COORD bottomright
 
     if (c == '\t')
     {
-        std::cout << ' ';
+        output(' ');
         changeCursor(' ');
         position = getCursorPosition();
         while (position.X - topleft.X % 8 != 0)
@@ -421,7 +674,7 @@ bool Display::printCharToProperPosition(char c, COORD topleft, COORD bottomright
                 }
                 break;
             }
-            std::cout << ' ';
+            output(' ');
             changeCursor(' ');
             position = getCursorPosition();
         }
@@ -448,7 +701,7 @@ bool Display::printCharToProperPosition(char c, COORD topleft, COORD bottomright
                 position = getCursorPosition();
             }
         }
-        std::cout << c;
+        output(c);
         changeCursor(c);
 #ifdef _WIN32
         if (specialCharCursor % 2 == 0)
@@ -463,7 +716,7 @@ bool Display::printCharToProperPosition(char c, COORD topleft, COORD bottomright
 
     if (c >= 32 && c <= 126)
     {
-        std::cout << c;
+        output(c);
         changeCursor(c);
         updateCursorPosition();
         return true;
@@ -472,6 +725,122 @@ bool Display::printCharToProperPosition(char c, COORD topleft, COORD bottomright
     return true;
 }
 
+Display::Template::Template(const std::string& format)
+{
+    this->parameterCount = 0;
+    // Text is split at every '#' first, so "&" before "#" is printed as it is, like showText(text, parameters) does
+    std::string segment;
+    for (size_t i = 0; i < format.size() && format[i] != '\0'; i++)
+    {
+        if (format[i] == '#')
+        {
+            this->parseSegment(segment);
+            segment.clear();
+            Token token = { PARAMETER, "", 0, 0, this->parameterCount };
+            this->tokens.push_back(token);
+            this->parameterCount++;
+        }
+        else
+        {
+            segment += format[i];
+        }
+    }
+    this->parseSegment(segment);
+}
+
+void Display::Template::parseSegment(const std::string& segment)
+{
+    std::string text;
+    // Add the pending text as a token, merged with the text token before it
+    auto addText = [&]()
+    {
+        if (text.size() == 0)
+        {
+            return;
+        }
+        if (this->tokens.size() == 0 || this->tokens.back().type != TEXT)
+        {
+            Token token = { TEXT, "", 0, 0, 0 };
+            this->tokens.push_back(token);
+        }
+        Token& token = this->tokens.back();
+        token.text += text;
+        text.clear();
+        // Only printable ASCII characters have a known width
+        token.width = token.text.size();
+        for (char c : token.text)
+        {
+            if (c < 32 || c > 126)
+            {
+                token.width = SIZE_MAX;
+                break;
+            }
+        }
+    };
+    for (size_t i = 0; i < segment.size(); i++)
+    {
+        if (segment[i] != '&' || i + 1 == segment.size())
+        {
+            text += segment[i];
+            continue;
+        }
+        char code = segment[i + 1];
+        bool isColorCode = (code >= '0' && code <= '9') || (code >= 'a' && code <= 'f') || (code >= 'A' && code <= 'F') || code == 'r' || code == 'R';
+        if (isColorCode == false)
+        {
+            // Failed to match any color, show the original characters
+            text += segment[i];
+            text += code;
+            i++;
+            continue;
+        }
+        addText();
+        // A color which is replaced before any text is printed is skipped
+        if (this->tokens.size() > 0 && this->tokens.back().type == COLOR)
+        {
+            this->tokens.back().colorCode = code;
+        }
+        else
+        {
+            Token token = { COLOR, "", 0, code, 0 };
+            this->tokens.push_back(token);
+        }
+        i++;
+    }
+    addText();
+}
+
+size_t Display::Template::getParameterCount() const
+{
+    return this->parameterCount;
+}
+
+Display::Writer::Writer()
+{
+}
+
+void Display::Writer::write(const char* text, size_t size)
+{
+    output(text, size);
+    changeCursor(text, size);
+}
+
+void Display::Writer::write(const char* text)
+{
+    this->write(text, strlen(text));
+}
+
+void Display::Writer::write(const std::string& text)
+{
+    this->write(text.data(), text.size());
+}
+
+void Display::Writer::write(char c)
+{
+    output(c);
+    changeCursor(c);
+}
+
 Display::Display()
 {
     this->startTime = std::chrono::system_clock::now();
@@ -480,6 +849,16 @@ Display::Display()
 
 Display::~Display()
 {
+    bool isOwner = false;
+    {
+        std::lock_guard<std::mutex> lock(asyncLog.mtx);
+        isOwner = asyncLog.owner == this;
+    }
+    // Print the queued records before the writer thread stops
+    if (isOwner)
+    {
+        this->stopAsync();
+    }
     // Reset the color
     setTextColor('r');
 }
@@ -487,7 +866,10 @@ Display::~Display()
 bool Display::setTextColor(char colorCode)
 {
     // Note: Based on the windows platform behavior
+    OutputScope scope;
 #ifdef _WIN32
+    // The attribute applies to the text written after it
+    flushOutput();
     HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
     if (colorCode >= '0' && colorCode <= '9')
     {
@@ -525,7 +907,7 @@ bool Display::setTextColor(char colorCode)
     }
     else if (colorCode == 'r' || colorCode == 'R')
     {
-        std::cout << "\033[0m";
+        output("\033[0m");
         std::lock_guard<std::mutex> lock(mtx);
         cursorColor = std::string(1, colorCode);
         return true;
@@ -538,7 +920,7 @@ bool Display::setTextColor(char colorCode)
                                     "197;15;31", "136;23;152", "193;156;0", "204;204;204",
                                     "118;118;118", "54;120;255", "22;198;12", "97;214;214",
                                     "231;72;86", "180;0;158", "249;241;165", "242;242;242" };
-    std::cout << "\033[38;2;" << colorCodeColor[color] << "m";
+    output("\033[38;2;" + colorCodeColor[color] + "m");
 #endif
     std::lock_guard<std::mutex> lock(mtx);
     cursorColor = std::string(1, colorCode);
@@ -553,7 +935,8 @@ bool Display::setTextColor(int red, int green, int blue)
         return false;
     }
     // \033[38;2;<r>;<g>;<b>m<text>\033[0m
-    std::cout << "\033[38;2;" << red << ";" << green << ";" << blue << "m";
+    OutputScope scope;
+    output("\033[38;2;" + std::to_string(red) + ";" + std::to_string(green) + ";" + std::to_string(blue) + "m");
     std::lock_guard<std::mutex> lock(mtx);
     cursorColor = colorToHex(red, green, blue);
     return true;
@@ -653,28 +1036,32 @@ std::vector<char> Display::getInput()
 
 void Display::clear()
 {
+    OutputScope scope;
     setTextColor('r');
     std::lock_guard<std::mutex> lock(mtx);
     cursorPosition.X = 0;
     cursorPosition.Y = 0;
+    isCursorExact = true;
+    updateConsoleSize();
+    checkCursorExact();
 #ifdef _WIN32
+    flushOutput();
     system("cls");
     SetConsoleCursorPosition(GetStdHandle(STD_OUTPUT_HANDLE), cursorPosition);
 #else
-    std::cout << "\033[2J\033[1;1H";
+    output("\033[2J\033[1;1H");
 #endif
 }
 
 void Display::clear(size_t length, COORD position, char c, bool freezeCursor)
 {
     // Note: require accurate cursor position if freezeCursor is true
+    OutputScope scope;
     COORD originalPosition = getCursorPosition();
     setCursorPosition(position);
-    for (size_t i = 0; i < length; i++)
-    {
-        std::cout << c;
-        changeCursor(c);
-    }
+    std::string fill(length, c);
+    output(fill);
+    changeCursor(fill);
     if (freezeCursor)
     {
         setCursorPosition(originalPosition);
@@ -690,13 +1077,15 @@ void Display::clear(size_t length, short x, short y, char c, bool freezeCursor)
 
 void Display::print(const std::string& text)
 {
-    std::cout << text;
+    OutputScope scope;
+    output(text);
     this->changeCursor(text);
     this->updateCursorPosition();
 }
 
 void Display::print(const std::string& text, int red, int green, int blue, bool resetColor)
 {
+    OutputScope scope;
     std::string clr = getCursorColor();
     bool isColorValid = this->setTextColor(red, green, blue);
     if (isColorValid == false)
@@ -713,6 +1102,7 @@ void Display::print(const std::string& text, int red, int green, int blue, bool
 
 void Display::print(const std::string& text, const std::vector<int>& color, bool resetColor)
 {
+    OutputScope scope;
     std::string clr = getCursorColor();
     bool isColorValid = this->setTextColor(color);
     if (isColorValid == false)
@@ -729,6 +1119,7 @@ void Display::print(const std::string& text, const std::vector<int>& color, bool
 
 void Display::print(const std::string& text, std::string color, bool resetColor)
 {
+    OutputScope scope;
     std::string clr = getCursorColor();
     bool isColorValid = this->setTextColor(color);
     if (isColorValid == false)
@@ -745,14 +1136,18 @@ void Display::print(const std::string& text, std::string color, bool resetColor)
 
 void Display::showText(char c, char colorCode)
 {
+    OutputScope scope;
     this->setTextColor(colorCode);
-    std::cout << c;
+    output(c);
     this->changeCursor(c);
     this->updateCursorPosition();
 }
 
 void Display::showText(const std::string& text)
 {
+    OutputScope scope;
+    // Characters between color codes are queued as one run
+    std::string run;
     size_t i = 0;
     bool isColorChar = false;
 
@@ -767,13 +1162,15 @@ void Display::showText(const std::string& text)
 
         if (isColorChar)
         {
+            output(run);
+            this->changeCursor(run);
+            run.clear();
             bool setColorResult = this->setTextColor(text[i]);
             if (setColorResult == false)
             {
                 // Failed to match any color, show the original character
-                std::cout << "&" << text[i];
-                this->changeCursor('&');
-                this->changeCursor(text[i]);
+                run += '&';
+                run += text[i];
             }
 
             isColorChar = false;
@@ -781,53 +1178,63 @@ void Display::showText(const std::string& text)
             continue;
         }
 
-        std::cout << text[i];
-        this->changeCursor(text[i]);
+        run += text[i];
         i++;
     }
 
     // String ending with character '&'
     if (isColorChar)
     {
-        std::cout << "&";
-        this->changeCursor('&');
+        run += '&';
     }
+    output(run);
+    this->changeCursor(run);
 
     this->updateCursorPosition();
 }
 
 void Display::showText(const std::string& text, const std::vector<std::string>& parameters)
 {
-    std::string buffer;
-    size_t inputTextIndex = 0;
-    size_t parameterIndex = 0;
-    while (text[inputTextIndex] != '\0')
+    this->showText(Template(text), parameters);
+}
+
+void Display::showText(const Template& format, const std::vector<std::string>& parameters)
+{
+    this->showTemplate(format, parameters.size(), [&](Writer& writer, size_t index) { writer.write(parameters[index]); });
+}
+
+void Display::showTemplate(const Template& format, size_t parameterCount, const std::function<void(Writer&, size_t)>& writeParameter)
+{
+    OutputScope scope;
+    Writer writer;
+    for (const Template::Token& token : format.tokens)
     {
-        if (text[inputTextIndex] == '#')
+        if (token.type == Template::TEXT)
         {
-            // show text before '#'
-            this->showText(buffer);
-            buffer.clear();
-            // show parameters
-            if (parameterIndex < parameters.size())
+            output(token.text);
+            if (token.width != SIZE_MAX)
             {
-                this->print(parameters[parameterIndex]);
+                this->moveCursorRight(token.width);
             }
             else
             {
-                this->print("#");
+                this->changeCursor(token.text);
             }
-            parameterIndex++;
+        }
+        else if (token.type == Template::COLOR)
+        {
+            this->setTextColor(token.colorCode);
+        }
+        else if (token.parameter < parameterCount)
+        {
+            writeParameter(writer, token.parameter);
         }
         else
         {
-            buffer += text[inputTextIndex];
+            writer.write('#');
         }
-        inputTextIndex++;
     }
-
-    // show text after the last '#'
-    this->showText(buffer);
+    this->updateCursorPosition();
 }
 
 void Display::showText(const std::string& text, const std::vector<int>& parameters)
@@ -844,6 +1251,7 @@ void Display::showText(const std::string& text, const std::vector<double>& param
 
 void Display::showText(const std::string& text1, const std::string& parameter, const std::string& text2)
 {
+    OutputScope scope;
     this->showText(text1);
     this->print(parameter);
     this->showText(text2);
@@ -851,6 +1259,7 @@ void Display::showText(const std::string& text1, const std::string& parameter, c
 
 void Display::showText(const std::string& text1, int parameter, const std::string& text2)
 {
+    OutputScope scope;
     this->showText(text1);
     this->print(std::to_string(parameter));
     this->showText(text2);
@@ -858,6 +1267,7 @@ void Display::showText(const std::string& text1, int parameter, const std::strin
 
 void Display::showText(const std::string& text1, double parameter, const std::string& text2, unsigned int accuracy)
 {
+    OutputScope scope;
     this->showText(text1);
     this->print(doubleToString(parameter, accuracy));
     this->showText(text2);
@@ -873,11 +1283,14 @@ void Display::createText(char c, COORD topleft, COORD bottomright, bool freezeCu
     {
         c = ' ';
     }
+    OutputScope scope;
     COORD originalPosition = getCursorPosition();
     setCursorPosition(topleft);
+    std::string row(bottomright.X - topleft.X + 1, c);
     for (short y = 0; y <= bottomright.Y - topleft.Y; y++)
     {
-        std::cout << std::string(bottomright.X - topleft.X + 1, c);
+        output(row);
+        changeCursor(row);
         setCursorPosition(topleft.X, topleft.Y + y + 1);
     }
     if (freezeCursor)
@@ -893,6 +1306,7 @@ void Display::createText(const std::string& text, COORD topleft, COORD bottomrig
         return;
     }
 
+    OutputScope scope;
     COORD originalPosition = getCursorPosition();
     setCursorPosition(topleft);
     size_t i = 0;
@@ -950,8 +1364,194 @@ void Display::createText(const std::string& text, COORD topleft, COORD bottomrig
     }
 }
 
+Display::AsyncQueue* Display::asyncQueue()
+{
+    // Close the queue when the thread exits, so that the writer can remove it
+    struct Handle
+    {
+        std::shared_ptr<AsyncQueue> queue;
+        uint64_t generation = 0;
+
+        ~Handle()
+        {
+            if (this->queue != nullptr)
+            {
+                this->queue->isClosed.store(true, std::memory_order_release);
+            }
+        }
+    };
+    static thread_local Handle handle;
+
+    uint64_t generation = asyncLog.generation.load(std::memory_order_acquire);
+    if (handle.queue == nullptr || handle.generation != generation)
+    {
+        if (handle.queue != nullptr)
+        {
+            handle.queue->isClosed.store(true, std::memory_order_release);
+        }
+        std::shared_ptr<AsyncQueue> queue = std::make_shared<AsyncQueue>();
+        queue->records.resize(asyncLog.capacity);
+        std::lock_guard<std::mutex> lock(asyncLog.mtx);
+        asyncLog.queues.push_back(queue);
+        handle.queue = queue;
+        handle.generation = generation;
+    }
+    return handle.queue.get();
+}
+
+size_t Display::drainAsync(size_t limit)
+{
+    std::vector<std::shared_ptr<AsyncQueue>> queues;
+    {
+        std::lock_guard<std::mutex> lock(asyncLog.mtx);
+        // Queues of exited threads are removed once they are empty
+        std::vector<std::shared_ptr<AsyncQueue>>& all = asyncLog.queues;
+        for (size_t i = all.size(); i-- > 0;)
+        {
+            if (all[i]->isClosed.load(std::memory_order_acquire) && all[i]->head.load(std::memory_order_relaxed) == all[i]->tail.load(std::memory_order_acquire))
+            {
+                all.erase(all.begin() + i);
+            }
+        }
+        queues = all;
+    }
+    OutputScope scope;
+    size_t count = 0;
+    while (count < limit)
+    {
+        // The oldest record at the front of any queue
+        AsyncQueue* next = nullptr;
+        uint64_t sequence = 0;
+        for (const std::shared_ptr<AsyncQueue>& queue : queues)
+        {
+            size_t head = queue->head.load(std::memory_order_relaxed);
+            if (head != queue->tail.load(std::memory_order_acquire))
+            {
+                const AsyncRecord& record = queue->records[head % queue->records.size()];
+                if (next == nullptr || record.sequence < sequence)
+                {
+                    next = queue.get();
+                    sequence = record.sequence;
+                }
+            }
+        }
+        if (next == nullptr)
+        {
+            break;
+        }
+        size_t head = next->head.load(std::memory_order_relaxed);
+        AsyncRecord& record = next->records[head % next->records.size()];
+        asyncLog.owner->showText(record.text);
+        record.text.clear();
+        next->head.store(head + 1, std::memory_order_release);
+        count++;
+    }
+    return count;
+}
+
+void Display::runAsyncWriter()
+{
+    while (true)
+    {
+        if (drainAsync(DISPLAY_ASYNC_BATCH_SIZE) > 0)
+        {
+            continue;
+        }
+        if (asyncLog.isStopping.load(std::memory_order_acquire))
+        {
+            // Every queue is empty
+            break;
+        }
+        std::unique_lock<std::mutex> lock(asyncLog.mtx);
+        asyncLog.isWriterWaiting.store(true, std::memory_order_release);
+        asyncLog.condition.wait_for(lock, std::chrono::milliseconds(DISPLAY_ASYNC_IDLE_WAIT));
+        asyncLog.isWriterWaiting.store(false, std::memory_order_release);
+    }
+}
+
+bool Display::startAsync(size_t capacity, bool isDropping)
+{
+    std::lock_guard<std::mutex> lock(asyncLog.mtx);
+    if (asyncLog.isRunning.load(std::memory_order_acquire) || asyncLog.writer.joinable())
+    {
+        return false;
+    }
+    asyncLog.capacity = capacity > 0 ? capacity : 1;
+    asyncLog.isDropping = isDropping;
+    asyncLog.owner = this;
+    asyncLog.queues.clear();
+    asyncLog.dropped.store(0, std::memory_order_relaxed);
+    asyncLog.isStopping.store(false, std::memory_order_relaxed);
+    asyncLog.generation.fetch_add(1, std::memory_order_release);
+    asyncLog.writer = std::thread(runAsyncWriter);
+    asyncLog.isRunning.store(true, std::memory_order_release);
+    return true;
+}
+
+void Display::stopAsync()
+{
+    std::thread writer;
+    {
+        std::lock_guard<std::mutex> lock(asyncLog.mtx);
+        if (asyncLog.isRunning.load(std::memory_order_acquire) == false)
+        {
+            return;
+        }
+        asyncLog.isRunning.store(false, std::memory_order_release);
+        asyncLog.isStopping.store(true, std::memory_order_release);
+        writer.swap(asyncLog.writer);
+        asyncLog.condition.notify_one();
+    }
+    writer.join();
+    // Records which were queued while the writer thread was stopping
+    drainAsync(SIZE_MAX);
+    std::lock_guard<std::mutex> lock(asyncLog.mtx);
+    asyncLog.queues.clear();
+    asyncLog.owner = nullptr;
+}
+
+bool Display::log(std::string text)
+{
+    if (asyncLog.isRunning.load(std::memory_order_acquire) == false)
+    {
+        this->showText(text);
+        return true;
+    }
+    AsyncQueue* queue = asyncQueue();
+    size_t tail = queue->tail.load(std::memory_order_relaxed);
+    while (tail - queue->head.load(std::memory_order_acquire) >= queue->records.size())
+    {
+        // The ring is full
+        if (asyncLog.isDropping)
+        {
+            asyncLog.dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (asyncLog.isWriterWaiting.load(std::memory_order_acquire))
+        {
+            asyncLog.condition.notify_one();
+        }
+        std::this_thread::yield();
+    }
+    AsyncRecord& record = queue->records[tail % queue->records.size()];
+    record.text = std::move(text);
+    record.sequence = asyncLog.sequence.fetch_add(1, std::memory_order_relaxed);
+    queue->tail.store(tail + 1, std::memory_order_release);
+    if (asyncLog.isWriterWaiting.load(std::memory_order_acquire))
+    {
+        asyncLog.condition.notify_one();
+    }
+    return true;
+}
+
+size_t Display::getDroppedCount()
+{
+    return asyncLog.dropped.load(std::memory_order_relaxed);
+}
+
 int Display::getInputInt(int max, bool canBelowZero)
 {
+    OutputScope scope;
     bool isBelowZero = false;
     int result = 0;
     int length = 0;
@@ -980,19 +1580,19 @@ int Display::getInputInt(int max, bool canBelowZero)
                 // Delete Digit
                 length--;
                 result = result / 10;
-                std::cout << '\b' << ' ' << '\b';
+                output("\b \b");
             }
             else if (length == 0 && isBelowZero == true)
             {
                 // Delete minus sign
                 isBelowZero = false;
-                std::cout << '\b' << ' ' << '\b';
+                output("\b \b");
             }
         }
         else if (cstr.size() == 1 && cstr[0] == '-' && isBelowZero == false && length == 0 && canBelowZero == true)
         {
             // Handle minus sign
-            std::cout << '-';
+            output('-');
             isBelowZero = true;
         }
         else if (cstr.size() == 1 && cstr[0] >= '0' && cstr[0] <= '9')
@@ -1002,14 +1602,14 @@ int Display::getInputInt(int max, bool canBelowZero)
             {
                 // Input is too large, replace the input with the maximum value
                 size_t visibleLength = length + (isBelowZero ? 1 : 0);
-                std::cout << std::string(visibleLength, '\b') << std::string(visibleLength, ' ') << std::string(visibleLength, '\b');
+                output(std::string(visibleLength, '\b') + std::string(visibleLength, ' ') + std::string(visibleLength, '\b'));
                 if (isBelowZero == true)
                 {
-                    std::cout << -max;
+                    output(std::to_string(-max));
                 }
                 else
                 {
-                    std::cout << max;
+                    output(std::to_string(max));
                 }
                 result = max;
                 length = maxLength;
@@ -1017,13 +1617,14 @@ int Display::getInputInt(int max, bool canBelowZero)
             else if (length == 1 && result == 0)
             {
                 // Leading 0 is not allowed, replace the input with the new input
-                std::cout << '\b' << cstr[0];
+                output('\b');
+                output(cstr[0]);
                 result = result * 10 - '0' + cstr[0];
             }
             else
             {
                 // Normal input
-                std::cout << cstr[0];
+                output(cstr[0]);
                 result = result * 10 - '0' + cstr[0];
                 length++;
             }
@@ -1042,6 +1643,7 @@ int Display::getInputInt(int max, bool canBelowZero)
 
 double Display::getInputDouble(bool canBelowZero, bool acceptNaN, size_t maxLength)
 {
+    OutputScope scope;
     bool isBelowZero = false;
     bool hasDot = false;
     bool isNaN = false;
@@ -1063,28 +1665,28 @@ double Display::getInputDouble(bool canBelowZero, bool acceptNaN, size_t maxLeng
                 // Delete minus sign
                 isBelowZero = false;
                 input.pop_back();
-                std::cout << '\b' << ' ' << '\b';
+                output("\b \b");
             }
             else if (input[input.size() - 1] == '.')
             {
                 // Delete dot
                 hasDot = false;
                 input.pop_back();
-                std::cout << '\b' << ' ' << '\b';
+                output("\b \b");
             }
             else if (input[input.size() - 1] == 'n')
             {
                 // Delete NaN (3 characters)
                 isNaN = false;
                 input.pop_back();
-                std::cout << "\b\b\b" << "   " << "\b\b\b";
+                output("\b\b\b   \b\b\b");
             }
             else if (input[input.size() - 1] == 'i')
             {
                 // Delete Infinity (8 characters)
                 isNaN = false;
                 input.pop_back();
-                std::cout << "\b\b\b\b\b\b\b\b" << "        " << "\b\b\b\b\b\b\b\b";
+                output("\b\b\b\b\b\b\b\b        \b\b\b\b\b\b\b\b");
             }
             else if (length > 0)
             {
@@ -1092,13 +1694,13 @@ double Display::getInputDouble(bool canBelowZero, bool acceptNaN, size_t maxLeng
                 length--;
                 result = result / 10;
                 input.pop_back();
-                std::cout << '\b' << ' ' << '\b';
+                output("\b \b");
             }
         }
         else if (cstr.size() == 1 && cstr[0] == '-' && isBelowZero == false && isNaN == false && length == 0 && canBelowZero == true)
         {
             // Handle minus sign
-            std::cout << '-';
+            output('-');
             input.push_back('-');
             isBelowZero = true;
         }
@@ -1108,25 +1710,25 @@ double Display::getInputDouble(bool canBelowZero, bool acceptNaN, size_t maxLeng
             if (length == 0)
             {
                 // Dot is not allowed at the beginning, fill with 0.
-                std::cout << '0';
+                output('0');
                 input.push_back('0');
                 length++;
             }
-            std::cout << '.';
+            output('.');
             input.push_back('.');
             hasDot = true;
         }
         else if (cstr.size() == 1 && (cstr[0] == 'n' || cstr[0] == 'N') && isNaN == false && acceptNaN && length == 0 && isBelowZero == false && hasDot == false)
         {
             // Handle NaN
-            std::cout << "NaN";
+            output("NaN");
             input.push_back('n');
             isNaN = true;
         }
         else if (cstr.size() == 1 && (cstr[0] == 'i' || cstr[0] == 'I') && isNaN == false && acceptNaN && length == 0 && hasDot == false)
         {
             // Handle Infinity
-            std::cout << "Infinity";
+            output("Infinity");
             input.push_back('i');
             isNaN = true;
         }
@@ -1136,12 +1738,13 @@ double Display::getInputDouble(bool canBelowZero, bool acceptNaN, size_t maxLeng
             if (length == 1 && input[input.size() - 1] == '0' && hasDot == false)
             {
                 // Leading 0 is not allowed, replace the input with the new input
-                std::cout << '\b' << cstr[0];
+                output('\b');
+                output(cstr[0]);
                 input[input.size() - 1] = cstr[0];
             }
             else if (length < maxLength)
             {
-                std::cout << cstr[0];
+                output(cstr[0]);
                 input.push_back(cstr[0]);
                 length++;
             }
@@ -1198,6 +1801,7 @@ double Display::getInputDouble(bool canBelowZero, bool acceptNaN, size_t maxLeng
 
 std::string Display::getInputText(size_t minLength, size_t maxLength, bool allowColor)
 {
+    OutputScope scope;
     std::string result = "";
     std::string asciiLabel = "";
     size_t cursorIndex = 0;
@@ -1322,11 +1926,12 @@ std::string Display::getInputText(size_t minLength, size_t maxLength, bool allow
 
 std::string Display::getInputString(std::string whitelistChar, std::string defaultValue, size_t minLength, size_t maxLength)
 {
+    OutputScope scope;
     std::string result = defaultValue;
     std::vector<char> cstr;
     size_t length = result.size();
 
-    std::cout << result;
+    output(result);
     cstr = getInput();
     while (inputIsEnter(cstr) == false || length < minLength)
     {
@@ -1336,7 +1941,7 @@ std::string Display::getInputString(std::string whitelistChar, std::string defau
             {
                 length--;
                 result.pop_back();
-                std::cout << '\b' << ' ' << '\b';
+                output("\b \b");
             }
         }
         else if (inputIsControlChar(cstr) == false && cstr.size() == 1 && length < maxLength)
@@ -1345,7 +1950,7 @@ std::string Display::getInputString(std::string whitelistChar, std::string defau
             {
                 result += cstr[0];
                 length++;
-                std::cout << cstr[0];
+                output(cstr[0]);
             }
         }
         cstr = getInput();
@@ -1501,14 +2106,28 @@ std::string Display::colorToHex(const std::vector<int>& color)
 
 void Display::setCursorPosition(short x, short y)
 {
+    OutputScope scope;
     std::lock_guard<std::mutex> lock(mtx);
-    cursorPosition.X = x;
-    cursorPosition.Y = y;
+    COORD target = { x, y };
+    // The console may have been resized since the position was made exact
+    updateConsoleSize();
+    checkCursorExact();
 #ifdef _WIN32
-    SetConsoleCursorPosition(GetStdHandle(STD_OUTPUT_HANDLE), cursorPosition);
+    flushOutput();
+    SetConsoleCursorPosition(GetStdHandle(STD_OUTPUT_HANDLE), target);
 #else
-    std::cout << "\033[" << y + 1 << ";" << x + 1 << "H";
+    if (isCursorExact)
+    {
+        output(cursorMotion(cursorPosition, target));
+    }
+    else
+    {
+        output(cursorMotion({ -1, -1 }, target));
+    }
 #endif
+    cursorPosition = target;
+    isCursorExact = true;
+    checkCursorExact();
 }
 
 void Display::setCursorPosition(COORD position)
@@ -1516,10 +2135,16 @@ void Display::setCursorPosition(COORD position)
     setCursorPosition(position.X, position.Y);
 }
 
+void Display::flush()
+{
+    flushOutput();
+}
+
 COORD Display::getCursorPosition()
 {
 #ifdef _WIN32
     // Try to update the Cursor Position Using Windows API First
+    flushOutput();
     CONSOLE_SCREEN_BUFFER_INFO csbi;
     if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi))
     {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <iostream>
+#include <climits>
 #include <cstring>
 #include <sstream>
 #include <vector>
@@ -8,11 +9,16 @@
 #include <cmath>
 #include <iomanip>
 #include <mutex>
+#include <string>
+#include <charconv>
+#include <functional>
+#include <type_traits>
 #ifdef _WIN32
 #include <conio.h>
 #include <Windows.h>
 #else
 #include <termios.h>
+#include <sys/ioctl.h>
 #include <unistd.h>
 struct COORD
 {
@@ -21,34 +27,99 @@ struct COORD
 };
 #endif
 
+// Output is collected in a buffer and written with a single system call when a public function returns, when flush() is called,
+// or as soon as the buffer reaches this many bytes
+#define DISPLAY_OUTPUT_BUFFER_SIZE 65536
+// Asynchronous logging: records queued by each producer thread, records printed between two flushes, and how long (in milliseconds)
+// the idle writer thread sleeps before it looks at the queues again without being woken up
+#define DISPLAY_ASYNC_QUEUE_SIZE 1024
+#define DISPLAY_ASYNC_BATCH_SIZE 256
+#define DISPLAY_ASYNC_IDLE_WAIT 10
+// Longest text of a double in fixed notation without its decimal digits: 309 integer digits, the sign and the decimal point
+#define DISPLAY_DOUBLE_LENGTH 311
+
+class Number;
+
+// Format of showText(format, parameters...) whose placeholders are counted at compile time, text must be a string literal
+// For example: display.showText(DISPLAY_FORMAT("&a# &rof #\n"), done, total);
+#define DISPLAY_FORMAT(text) [] { struct Format : Display::FormatString { static constexpr const char* value() { return text; } }; return Format(); }()
+
 // This class is platform-independent, but for best performance, it is recommended to use it on Windows
 // Even we tried to make it thread-safe, it is recommended to lock the instance in a multi-thread environment
 // To avoid unexpected behavior, if you use this class to print text to the console, please don't use std::cout at the same time
 // This is because we guess the current cursor position based on the text, if you use std::cout, we cannot update the cursor position in time
+// The output of this class is buffered, anything printed by other means while a call is in progress may appear before it
 // In Windows, we will try to update the cursor position using the Windows API to make it accurate
 // But in Linux, we can only guess the cursor position based on your input, so please clear the console before using this class
 // You can use the clear() function in this class to clear the console
 class Display
 {
+    friend class DisplayScreen;
+
 private:
     // try to lock static variables to make it thread-safe
     static std::mutex mtx;
     // current cursor position, may not be accurate
     static COORD cursorPosition;
+    // true if cursorPosition is known to be right, for example after an absolute move, so that relative moves are safe
+    static bool isCursorExact;
+    // columns and rows of the console when the cursor position was last made exact, 0 if unknown
+    static COORD consoleSize;
     // current cursor color
     static std::string cursorColor;
     // handle unicode characters
     static size_t specialCharCursor;
     // record the start time to support timing function
     std::chrono::system_clock::time_point startTime;
+    // text and escape sequences waiting to be written to the console
+    static std::string outputBuffer;
+    // lock outputBuffer, it is separate from mtx so that output can be queued while mtx is held
+    static std::mutex outputMtx;
+    // number of nested public calls on this thread, the buffer is flushed when the outermost one returns
+    static thread_local size_t outputDepth;
+
+    // Asynchronous logging state and the lock-free queue of one producer thread, defined in Display.cpp
+    struct AsyncLog;
+    struct AsyncQueue;
+    static AsyncLog asyncLog;
+
+    // Flush the output buffer when the outermost public call on this thread returns
+    class OutputScope
+    {
+    public:
+        OutputScope();
+        ~OutputScope();
+    };
 
     // Get a single input byte from the console
     static char c();
 
+    // Queue text for the console, the buffer is flushed once it reaches DISPLAY_OUTPUT_BUFFER_SIZE bytes
+    static void output(const char* data, size_t size);
+    static void output(const std::string& text);
+    static void output(char c);
+    // Write the whole output buffer to the console
+    static void flushOutput();
+
     // Guess the cursor position (mainly for non-Windows platform)
     static void changeCursor(char c);
+    // Guess the cursor position after a character, mtx must be held
+    static void moveCursor(char c);
+    // Read the console size into consoleSize, mtx must be held
+    static void updateConsoleSize();
+    // Keep isCursorExact only if consoleSize is known and the cursor is inside it, mtx must be held
+    static void checkCursorExact();
+    // Shortest byte sequence moving the cursor, chosen from CR, backspace, relative moves, column-absolute and absolute moves
+    static std::string cursorMotion(COORD from, COORD to);
+    // Queue at most maxSize characters written in place by fill(buffer), which returns the end of the text, return the number of characters
+    template <typename Fill>
+    static size_t outputInPlace(size_t maxSize, Fill fill);
+
     // Guess the new cursor position
     static void changeCursor(const std::string& text);
+    static void changeCursor(const char* text, size_t size);
+    // Move the guessed cursor position right after printing columns printable ASCII characters
+    static void moveCursorRight(size_t columns);
     // Use platform-specific API to get and update the actual cursor position, return false if failed
     static bool updateCursorPosition();
 
@@ -72,6 +143,13 @@ private:
     // Input is not a printable character, such as BACKSPACE, ENTER, ARROW KEYS, etc.
     static bool inputIsControlChar(const std::vector<char>& input);
 
+    // Queue of the calling thread for the running asynchronous mode, created on the first log() of the thread
+    static AsyncQueue* asyncQueue();
+    // Print up to limit queued records in the order they were logged, return the number of printed records
+    static size_t drainAsync(size_t limit);
+    // Body of the writer thread
+    static void runAsyncWriter();
+
     // Common algorithm
     // Called by getInputText to preview the input string with color support and update cursor position, return the visible length of the string
     size_t previewGetInputString(const std::string oClr, const std::string& iStr, size_t cIdx, size_t* lAcuIdx, size_t lVisLen, bool allowClr);
@@ -79,9 +157,102 @@ private:
     bool printCharToProperPosition(char c, COORD topleft, COORD bottomright, bool wideCharPredict);
 
 public:
+    // Format of showText() parsed once, for text which is printed many times with different parameters
+    // The syntax is the same as showText(text, parameters): "&+ColorCode" changes the color and "#" is a placeholder for a parameter
+    class Template
+    {
+        friend class Display;
+
+    private:
+        enum TokenType
+        {
+            TEXT,
+            COLOR,
+            PARAMETER
+        };
+
+        struct Token
+        {
+            TokenType type;
+            // TEXT: the characters to print
+            std::string text;
+            // TEXT: visible columns, SIZE_MAX if the text has characters whose width is guessed
+            size_t width;
+            // COLOR: the color code
+            char colorCode;
+            // PARAMETER: index of the parameter
+            size_t parameter;
+        };
+
+        std::vector<Token> tokens;
+        size_t parameterCount;
+
+        // Parse text between two placeholders, consecutive texts and consecutive colors are merged
+        void parseSegment(const std::string& segment);
+
+    public:
+        explicit Template(const std::string& format);
+        // Number of "#" placeholders
+        size_t getParameterCount() const;
+        // Number of "#" placeholders, usable in constant expressions
+        static constexpr size_t countParameters(const char* format)
+        {
+            size_t count = 0;
+            for (; *format != '\0'; format++)
+            {
+                if (*format == '#')
+                {
+                    count++;
+                }
+            }
+            return count;
+        }
+    };
+
+    // Base of the formats made by DISPLAY_FORMAT, value() returns the string literal
+    struct FormatString
+    {
+    };
+
+    // Prints the parameters of showText(format, parameters...) straight into the output buffer, color codes are not parsed
+    // Specialize DisplayFormatter to print other types with it
+    class Writer
+    {
+        friend class Display;
+
+    private:
+        Writer();
+
+    public:
+        void write(const char* text, size_t size);
+        void write(const char* text);
+        void write(const std::string& text);
+        void write(char c);
+        // "true" or "false"
+        template <typename Boolean>
+        typename std::enable_if<std::is_same<Boolean, bool>::value>::type write(Boolean value);
+        template <typename Integer>
+        typename std::enable_if<std::is_integral<Integer>::value && !std::is_same<Integer, bool>::value && !std::is_same<Integer, char>::value>::type write(Integer value);
+        // Fixed notation with accuracy decimal digits, the same as doubleToString()
+        template <typename Floating>
+        typename std::enable_if<std::is_floating_point<Floating>::value>::type write(Floating value, unsigned int accuracy = 4);
+        // Number is only declared here, so Number.h is needed only where a Number is printed
+        template <typename NumberType>
+        typename std::enable_if<std::is_same<NumberType, Number>::value>::type write(const NumberType& n);
+    };
+
+private:
+    // Walk a parsed template, writeParameter(writer, index) prints the parameter of a placeholder, "#" is printed for index >= parameterCount
+    void showTemplate(const Template& format, size_t parameterCount, const std::function<void(Writer&, size_t)>& writeParameter);
+    // Print a parameter of showText(format, parameters...) with its DisplayFormatter
+    template <typename Parameter>
+    static void writeParameter(Writer& writer, const void* value);
+
+public:
+
     // You need to create an instance if you want to use this class to print text to the console
     Display();
-    // Destruct the instance will reset the color to default
+    // Destruct the instance will reset the color to default, and stop the asynchronous mode if this instance started it
     ~Display();
 
     // Console related functions
@@ -122,6 +293,15 @@ public:
     void showText(const std::string& text, const std::vector<int>& parameters);
     // Print text. Use "&+ColorCode" to change color, "#" will be replaced to parameters, more "#" than parameters will be printed as "#"
     void showText(const std::string& text, const std::vector<double>& parameters, unsigned int accuracy = 4);
+    // Print a parsed template, the same as showText(text, parameters) without parsing text again
+    void showText(const Template& format, const std::vector<std::string>& parameters);
+    // Print a parsed template with parameters of any type printed by DisplayFormatter, without building strings for them
+    // Strings, characters, integers, floating-point numbers (4 decimal digits), bool and Number are supported, more "#" than parameters will be printed as "#"
+    template <typename... Parameters>
+    void showText(const Template& format, const Parameters&... parameters);
+    // The same for a format made by DISPLAY_FORMAT, it is parsed once and the number of parameters must match the placeholders at compile time
+    template <typename Format, typename... Parameters>
+    typename std::enable_if<std::is_base_of<FormatString, Format>::value>::type showText(const Format& format, const Parameters&... parameters);
     // Print text as "text1 + parameter + text2", "&+ColorCode" in text (not in parameter) will change the text color after them
     void showText(const std::string& text1, const std::string& parameter, const std::string& text2);
     // Print text as "text1 + parameter + text2", "&+ColorCode" will change the text color, but even if text1 end with "&", parameter will not be regarded as a ColorCode
@@ -135,6 +315,20 @@ public:
     // Print a text to a specific area in the console, set wideCharPredict to true to make sure 2-character-wide unicode characters not exceed the boundary
     void createText(const std::string& text, COORD topleft, COORD bottomright, bool wideCharPredict = true, bool freezeCursor = true);
 
+    // Asynchronous logging, for many threads printing at the same time
+    // A writer thread prints the records of log() one by one with showText(), so the records of different threads are never mixed within a line
+    // Every producer thread queues its records in its own lock-free ring, the records are printed in the order they were logged
+    // When a ring is full, log() waits for the writer, or drops the record if isDropping is true
+    // Other output functions are not queued, please only use log() while the asynchronous mode is running
+    // Start the writer thread, return false if the asynchronous mode is already running
+    bool startAsync(size_t capacity = DISPLAY_ASYNC_QUEUE_SIZE, bool isDropping = false);
+    // Print every queued record and stop the writer thread, the producers should have stopped logging
+    void stopAsync();
+    // Queue text with "&+ColorCode" colors, print it directly if the asynchronous mode is not running, return false if the record was dropped
+    bool log(std::string text);
+    // Number of records dropped since the asynchronous mode started
+    static size_t getDroppedCount();
+
     // User Input
     // Get an integer input from the console, set canBelowZero to true to accept negative numbers
     int getInputInt(int max = INT_MAX, bool canBelowZero = true);
@@ -164,10 +358,12 @@ public:
     static std::string colorToHex(const std::vector<int>& color);
 
     // Console related functions
-    // Set console cursor position
+    // Set console cursor position, a relative move is used instead of an absolute one when it is shorter and the current position is known
     static void setCursorPosition(short x, short y);
     // Set console cursor position
     static void setCursorPosition(COORD position);
+    // Write the buffered output to the console now
+    static void flush();
     // Get cursor position, may not be accurate (especially in non-Windows platform)
     static COORD getCursorPosition();
     // Get cursor position X (Column)
@@ -182,4 +378,89 @@ public:
     void timeStart();
     // Get the duration from the start time to the current system time in seconds
     double getDurationSeconds();
-};
\ No newline at end of file
+};
+
+// Customization point of showText(format, parameters...), specialize it with a static format(Display::Writer&, const T&) to print other types
+template <typename T>
+struct DisplayFormatter
+{
+    static void format(Display::Writer& writer, const T& value)
+    {
+        writer.write(value);
+    }
+};
+
+template <typename Fill>
+size_t Display::outputInPlace(size_t maxSize, Fill fill)
+{
+    size_t size = 0;
+    bool isFull = false;
+    {
+        std::lock_guard<std::mutex> lock(outputMtx);
+        size_t first = outputBuffer.size();
+        outputBuffer.resize(first + maxSize);
+        size = fill(&outputBuffer[first]) - &outputBuffer[first];
+        outputBuffer.resize(first + size);
+        isFull = outputBuffer.size() >= DISPLAY_OUTPUT_BUFFER_SIZE;
+    }
+    if (isFull)
+    {
+        flushOutput();
+    }
+    return size;
+}
+
+template <typename Parameter>
+void Display::writeParameter(Writer& writer, const void* value)
+{
+    // Arrays are printed as pointers, so string literals of any length share DisplayFormatter<const char*>
+    typedef typename std::decay<const Parameter>::type Type;
+    DisplayFormatter<Type>::format(writer, *static_cast<const Parameter*>(value));
+}
+
+template <typename... Parameters>
+void Display::showText(const Template& format, const Parameters&... parameters)
+{
+    // The walk over the tokens is not a template, it reaches the parameters through their addresses and the writer of each type
+    const void* values[] = { &parameters..., nullptr };
+    void (*writers[])(Writer&, const void*) = { &Display::writeParameter<Parameters>..., nullptr };
+    this->showTemplate(format, sizeof...(Parameters), [&](Writer& writer, size_t index) { writers[index](writer, values[index]); });
+}
+
+template <typename Format, typename... Parameters>
+typename std::enable_if<std::is_base_of<Display::FormatString, Format>::value>::type Display::showText(const Format&, const Parameters&... parameters)
+{
+    static_assert(Template::countParameters(Format::value()) == sizeof...(Parameters), "showText: the number of parameters does not match the placeholders of the format");
+    // Every DISPLAY_FORMAT is a different type, so each of them is parsed once
+    static const Template format(Format::value());
+    this->showText(format, parameters...);
+}
+
+template <typename Boolean>
+typename std::enable_if<std::is_same<Boolean, bool>::value>::type Display::Writer::write(Boolean value)
+{
+    this->write(value ? "true" : "false");
+}
+
+template <typename Integer>
+typename std::enable_if<std::is_integral<Integer>::value && !std::is_same<Integer, bool>::value && !std::is_same<Integer, char>::value>::type Display::Writer::write(Integer value)
+{
+    // 20 digits and the sign of any 64-bit integer
+    size_t size = outputInPlace(21, [&](char* buffer) { return std::to_chars(buffer, buffer + 21, value).ptr; });
+    moveCursorRight(size);
+}
+
+template <typename Floating>
+typename std::enable_if<std::is_floating_point<Floating>::value>::type Display::Writer::write(Floating value, unsigned int accuracy)
+{
+    size_t maxSize = DISPLAY_DOUBLE_LENGTH + accuracy;
+    size_t size = outputInPlace(maxSize, [&](char* buffer) { return std::to_chars(buffer, buffer + maxSize, (double)value, std::chars_format::fixed, (int)accuracy).ptr; });
+    moveCursorRight(size);
+}
+
+template <typename NumberType>
+typename std::enable_if<std::is_same<NumberType, Number>::value>::type Display::Writer::write(const NumberType& n)
+{
+    size_t size = outputInPlace(n.getTextLength(), [&](char* buffer) { return n.writeText(buffer); });
+    moveCursorRight(size);
+}
@@ -0,0 +1,394 @@
+#include "DisplayScreen.h"
+
+bool DisplayScreen::Cell::operator == (const Cell& c) const
+{
+    return std::memcmp(this->glyph, c.glyph, sizeof(this->glyph)) == 0 && this->width == c.width && this->hasSameStyle(c);
+}
+
+bool DisplayScreen::Cell::operator != (const Cell& c) const
+{
+    return !(*this == c);
+}
+
+bool DisplayScreen::Cell::hasSameStyle(const Cell& c) const
+{
+    if (this->colorCode != c.colorCode)
+    {
+        return false;
+    }
+    return this->colorCode != 0 || (this->red == c.red && this->green == c.green && this->blue == c.blue);
+}
+
+DisplayScreen::Cell DisplayScreen::blank()
+{
+    Cell cell = { { ' ', 0, 0, 0 }, 1, 'r', 0, 0, 0 };
+    return cell;
+}
+
+DisplayScreen::DisplayScreen(Display& display, short width, short height, COORD origin) : display(display)
+{
+    this->origin = origin;
+    this->width = 0;
+    this->height = 0;
+    this->pen = blank();
+    this->resize(width, height);
+}
+
+short DisplayScreen::getWidth() const
+{
+    return this->width;
+}
+
+short DisplayScreen::getHeight() const
+{
+    return this->height;
+}
+
+void DisplayScreen::resize(short width, short height)
+{
+    width = width > 0 ? width : 0;
+    height = height > 0 ? height : 0;
+    std::vector<Cell> resized((size_t)width * height, blank());
+    for (short y = 0; y < height && y < this->height; y++)
+    {
+        for (short x = 0; x < width && x < this->width; x++)
+        {
+            resized[(size_t)y * width + x] = this->back[(size_t)y * this->width + x];
+        }
+        // A wide glyph cut by the new right edge
+        if (width > 0 && resized[(size_t)y * width + width - 1].width == 2)
+        {
+            resized[(size_t)y * width + width - 1] = blank();
+        }
+    }
+    this->back.swap(resized);
+    this->front.assign(this->back.size(), blank());
+    this->width = width;
+    this->height = height;
+    this->isFrontValid = false;
+}
+
+void DisplayScreen::invalidate()
+{
+    this->isFrontValid = false;
+}
+
+bool DisplayScreen::setTextColor(char colorCode)
+{
+    bool isValid = (colorCode >= '0' && colorCode <= '9') || (colorCode >= 'a' && colorCode <= 'f') || (colorCode >= 'A' && colorCode <= 'F') || colorCode == 'r' || colorCode == 'R';
+    if (isValid == false)
+    {
+        return false;
+    }
+    this->pen.colorCode = colorCode;
+    this->pen.red = 0;
+    this->pen.green = 0;
+    this->pen.blue = 0;
+    return true;
+}
+
+bool DisplayScreen::setTextColor(int red, int green, int blue)
+{
+    if (red < 0 || red > 255 || green < 0 || green > 255 || blue < 0 || blue > 255)
+    {
+        return false;
+    }
+    this->pen.colorCode = 0;
+    this->pen.red = (uint8_t)red;
+    this->pen.green = (uint8_t)green;
+    this->pen.blue = (uint8_t)blue;
+    return true;
+}
+
+void DisplayScreen::clear()
+{
+    this->back.assign(this->back.size(), blank());
+}
+
+void DisplayScreen::put(short x, short y, const Cell& cell)
+{
+    Cell* row = this->back.data() + (size_t)y * this->width;
+    Cell space = row[x];
+    std::memcpy(space.glyph, " \0\0\0", sizeof(space.glyph));
+    space.width = 1;
+    // Do not leave half of a wide glyph behind
+    if (row[x].width == 0 && x > 0)
+    {
+        row[x - 1] = space;
+    }
+    if (row[x].width == 2 && x + 1 < this->width)
+    {
+        row[x + 1] = space;
+    }
+    row[x] = cell;
+    if (cell.width == 2)
+    {
+        if (row[x + 1].width == 2 && x + 2 < this->width)
+        {
+            row[x + 2] = space;
+        }
+        Cell continuation = cell;
+        std::memset(continuation.glyph, 0, sizeof(continuation.glyph));
+        continuation.width = 0;
+        row[x + 1] = continuation;
+    }
+}
+
+void DisplayScreen::fill(char c, COORD topleft, COORD bottomright)
+{
+    if (c < 32 || c > 126)
+    {
+        c = ' ';
+    }
+    Cell cell = this->pen;
+    std::memset(cell.glyph, 0, sizeof(cell.glyph));
+    cell.glyph[0] = c;
+    cell.width = 1;
+    for (short y = topleft.Y > 0 ? topleft.Y : 0; y <= bottomright.Y && y < this->height; y++)
+    {
+        for (short x = topleft.X > 0 ? topleft.X : 0; x <= bottomright.X && x < this->width; x++)
+        {
+            this->put(x, y, cell);
+        }
+    }
+}
+
+bool DisplayScreen::drawText(const std::string& text, COORD topleft, COORD bottomright)
+{
+    short left = topleft.X > 0 ? topleft.X : 0;
+    short top = topleft.Y > 0 ? topleft.Y : 0;
+    short right = bottomright.X < this->width ? bottomright.X : this->width - 1;
+    short bottom = bottomright.Y < this->height ? bottomright.Y : this->height - 1;
+    if (left > right || top > bottom)
+    {
+        return text.size() == 0;
+    }
+    short x = left;
+    short y = top;
+    size_t i = 0;
+    bool isColorChar = false;
+    // The character after '&' of an invalid color code is drawn as it is, it cannot start another color code
+    bool isCodeLiteral = false;
+    while (i < text.size() && text[i] != '\0')
+    {
+        if (text[i] == '&' && isColorChar == false && isCodeLiteral == false && i + 1 < text.size())
+        {
+            isColorChar = true;
+            i++;
+            continue;
+        }
+        isCodeLiteral = false;
+        // An invalid color code is drawn as it is
+        size_t size = 1;
+        Cell cell = this->pen;
+        std::memset(cell.glyph, 0, sizeof(cell.glyph));
+        if (isColorChar)
+        {
+            isColorChar = false;
+            if (this->setTextColor(text[i]))
+            {
+                i++;
+                continue;
+            }
+            cell.glyph[0] = '&';
+            isCodeLiteral = true;
+            i--;
+        }
+        else
+        {
+            unsigned char lead = (unsigned char)text[i];
+            if (lead == '\n' || lead == '\r')
+            {
+                x = left;
+                y += lead == '\n' ? 1 : 0;
+                i++;
+                continue;
+            }
+            if (lead == '\t')
+            {
+                // Spaces up to the next tab stop of the rectangle
+                Cell space = this->pen;
+                std::memcpy(space.glyph, " \0\0\0", sizeof(space.glyph));
+                space.width = 1;
+                do
+                {
+                    if (x > right)
+                    {
+                        break;
+                    }
+                    if (y > bottom)
+                    {
+                        return false;
+                    }
+                    this->put(x, y, space);
+                    x++;
+                } while ((x - left) % 8 != 0);
+                i++;
+                continue;
+            }
+            if (lead < 32 || lead == 127)
+            {
+                i++;
+                continue;
+            }
+            size = lead >= 0xF0 ? 4 : (lead >= 0xE0 ? 3 : (lead >= 0xC0 ? 2 : 1));
+            size = i + size <= text.size() ? size : text.size() - i;
+            std::memcpy(cell.glyph, text.data() + i, size);
+        }
+        // Multi-byte glyphs of 3 or more bytes are assumed to be 2 columns wide, like Display does
+        cell.width = size >= 3 ? 2 : 1;
+        if (x + cell.width - 1 > right)
+        {
+            x = left;
+            y++;
+        }
+        if (y > bottom || x + cell.width - 1 > right)
+        {
+            return false;
+        }
+        this->put(x, y, cell);
+        x += cell.width;
+        i += size;
+    }
+    return true;
+}
+
+bool DisplayScreen::drawText(const std::string& text, short x, short y)
+{
+    COORD topleft = { x, y };
+    COORD bottomright = { (short)(this->width - 1), y };
+    return this->drawText(text, topleft, bottomright);
+}
+
+void DisplayScreen::printRun(short y, short first, short last, Cell* style)
+{
+    const Cell* row = this->back.data() + (size_t)y * this->width;
+    std::string run;
+    // Wide glyphs are only guessed to be 2 columns wide
+    bool isWidthGuessed = false;
+    for (short x = first; x < last; x++)
+    {
+        const Cell& cell = row[x];
+        if (cell.width == 0)
+        {
+            continue;
+        }
+        if (cell.width == 2)
+        {
+            isWidthGuessed = true;
+        }
+        if (cell.hasSameStyle(*style) == false)
+        {
+            Display::output(run);
+            run.clear();
+            if (cell.colorCode != 0)
+            {
+                this->display.setTextColor(cell.colorCode);
+            }
+            else
+            {
+                this->display.setTextColor(cell.red, cell.green, cell.blue);
+            }
+            *style = cell;
+        }
+        run.append(cell.glyph, strnlen(cell.glyph, sizeof(cell.glyph)));
+    }
+    Display::output(run);
+    // The cursor follows the cells, there is no need to guess it from the bytes
+    std::lock_guard<std::mutex> lock(Display::mtx);
+    Display::cursorPosition.X = this->origin.X + last;
+    Display::cursorPosition.Y = this->origin.Y + y;
+    Display::specialCharCursor = 0;
+    // Relative moves are not safe if a guessed width was wrong, or if the run reached the last column of the console
+    if (isWidthGuessed)
+    {
+        Display::isCursorExact = false;
+    }
+    Display::checkCursorExact();
+}
+
+void DisplayScreen::present(bool freezeCursor)
+{
+    Display::OutputScope scope;
+    COORD originalPosition = Display::getCursorPosition();
+    std::string originalColor = Display::getCursorColor();
+    // Style of the console before the first change
+    Cell style = blank();
+    if (originalColor.size() == 1)
+    {
+        style.colorCode = originalColor[0];
+    }
+    else
+    {
+        std::vector<int> color = Display::hexToColor(originalColor);
+        style.colorCode = 0;
+        style.red = (uint8_t)color[0];
+        style.green = (uint8_t)color[1];
+        style.blue = (uint8_t)color[2];
+    }
+    Cell initialStyle = style;
+    bool hasMoved = false;
+
+    for (short y = 0; y < this->height; y++)
+    {
+        const Cell* back = this->back.data() + (size_t)y * this->width;
+        Cell* front = this->front.data() + (size_t)y * this->width;
+        short x = 0;
+        while (x < this->width)
+        {
+            if (this->isFrontValid && back[x] == front[x])
+            {
+                x++;
+                continue;
+            }
+            // Start at the first column of a wide glyph
+            short first = (back[x].width == 0 && x > 0) ? x - 1 : x;
+            // Extend the run over gaps of unchanged cells when reprinting them costs fewer bytes than moving the cursor
+            short last = x + 1;
+            while (last < this->width)
+            {
+                if (this->isFrontValid == false || back[last] != front[last])
+                {
+                    last++;
+                    continue;
+                }
+                short next = last;
+                size_t gapBytes = 0;
+                bool isSameStyle = true;
+                while (next < this->width && back[next] == front[next])
+                {
+                    gapBytes += strnlen(back[next].glyph, sizeof(back[next].glyph));
+                    isSameStyle = isSameStyle && back[next].hasSameStyle(back[last - 1]);
+                    next++;
+                }
+                COORD from = { (short)(this->origin.X + last), (short)(this->origin.Y + y) };
+                COORD to = { (short)(this->origin.X + next), (short)(this->origin.Y + y) };
+                if (next == this->width || isSameStyle == false || gapBytes > Display::cursorMotion(from, to).size())
+                {
+                    break;
+                }
+                last = next;
+            }
+            // End after the second column of a wide glyph
+            if (last < this->width && back[last].width == 0)
+            {
+                last++;
+            }
+            Display::setCursorPosition(this->origin.X + first, this->origin.Y + y);
+            this->printRun(y, first, last, &style);
+            std::copy(back + first, back + last, front + first);
+            hasMoved = true;
+            x = last;
+        }
+    }
+    this->isFrontValid = true;
+
+    if (style.hasSameStyle(initialStyle) == false)
+    {
+        this->display.setTextColor(originalColor);
+    }
+    if (freezeCursor && hasMoved)
+    {
+        Display::setCursorPosition(originalPosition);
+    }
+}
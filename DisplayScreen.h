@@ -0,0 +1,80 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "Display.h"
+
+// Retained screen model for Display, a back buffer which callers draw into and a front buffer which holds what the console shows
+// present() only writes the cells that differ between them, merged into runs, so a screen which is refreshed often with few changes
+// costs a few bytes per frame instead of a full redraw
+// Unchanged cells between two runs are reprinted when that is shorter than the cursor motion over them
+// The screen covers a rectangle of the console starting at origin, nothing else should print into it while the screen is in use
+// Call invalidate() after the console was cleared or scrolled, so that the next present() redraws everything
+class DisplayScreen
+{
+private:
+    struct Cell
+    {
+        // UTF-8 bytes of the glyph, unused bytes are 0
+        char glyph[4];
+        // columns taken by the glyph, 0 for the second column of a wide glyph
+        uint8_t width;
+        // color code, or 0 if the color is red, green, blue
+        char colorCode;
+        uint8_t red;
+        uint8_t green;
+        uint8_t blue;
+
+        bool operator == (const Cell& c) const;
+        bool operator != (const Cell& c) const;
+        bool hasSameStyle(const Cell& c) const;
+    };
+
+    Display& display;
+    COORD origin;
+    short width;
+    short height;
+    // cells of row y start at y * width
+    std::vector<Cell> front;
+    std::vector<Cell> back;
+    // false if the console content is unknown
+    bool isFrontValid;
+    // style used by the next drawn glyphs
+    Cell pen;
+
+    // Space with the default color
+    static Cell blank();
+    // Store a glyph in the back buffer, broken halves of wide glyphs around it become spaces
+    void put(short x, short y, const Cell& cell);
+    // Print back buffer cells [first, last) of row y, the cursor must be at the first one, style is the last printed style
+    void printRun(short y, short first, short last, Cell* style);
+
+public:
+    DisplayScreen(Display& display, short width, short height, COORD origin = { 0, 0 });
+
+    short getWidth() const;
+    short getHeight() const;
+    // Change the size, the content is kept where it fits and the next present() redraws everything
+    void resize(short width, short height);
+    // Forget what the console shows, the next present() redraws everything
+    void invalidate();
+
+    // Drawing to the back buffer, nothing is printed until present()
+    // Set the color of the next drawn text with a color code, see Display::setTextColor, return false if the color code is invalid
+    bool setTextColor(char colorCode);
+    // Set the color of the next drawn text with RGB color, return false if rgb value is < 0 or > 255
+    bool setTextColor(int red, int green, int blue);
+    // Fill the whole back buffer with spaces of the default color
+    void clear();
+    // Fill a rectangle with a single character in the current color
+    void fill(char c, COORD topleft, COORD bottomright);
+    // Draw text into a rectangle like Display::createText, "&+ColorCode" changes the color, lines wrap inside the rectangle
+    // Return false if the text did not fit
+    bool drawText(const std::string& text, COORD topleft, COORD bottomright);
+    // Draw text from a position to the end of the screen line
+    bool drawText(const std::string& text, short x, short y);
+
+    // Print the changed cells, the console cursor goes back to where it was if freezeCursor is true
+    void present(bool freezeCursor = true);
+};
@@ -0,0 +1,459 @@
+#include "LazyReal.h"
+
+#include <mutex>
+#include <stdexcept>
+
+// Best approximation of pi calculated so far, shared by every PI node, piValue is only replaced while piMutex is held
+static std::mutex piMutex;
+static size_t piPrecision = 0;
+static Number piValue;
+
+LazyReal::LazyReal(NodeType type, const std::shared_ptr<Node>& left, const std::shared_ptr<Node>& right)
+{
+    this->node = std::make_shared<Node>();
+    this->node->type = type;
+    this->node->left = left;
+    this->node->right = right;
+    this->node->isCached = false;
+    this->node->cachedPrecision = 0;
+    this->node->integerDigits = 0;
+    this->node->leadingZeros = 0;
+    this->node->hasLeadingZeros = false;
+}
+
+Number LazyReal::scale(const Number& n, long digits, bool isRounded)
+{
+    long shift = digits - (long)n.decimal.size();
+    if (shift >= 0)
+    {
+        return Number::fromLimbs(n.toLimbs((size_t)shift), 0, n.isNegative, DEFAULT_LENGTH);
+    }
+    NumberKernel::Limbs a = n.toLimbs();
+    if (a.size() == 0)
+    {
+        return Number();
+    }
+    NumberKernel::Limbs d = Number(1).toLimbs((size_t)(-shift));
+    if (isRounded)
+    {
+        // (2a + d) / 2d rounds half away from zero
+        a = NumberKernel::add(NumberKernel::multiplySmall(a, 2, LIMB_BASE), d, LIMB_BASE);
+        d = NumberKernel::multiplySmall(d, 2, LIMB_BASE);
+    }
+    NumberKernel::Limbs quotient;
+    NumberKernel::divide(a, d, LIMB_BASE, &quotient, nullptr);
+    return Number::fromLimbs(quotient, 0, n.isNegative, DEFAULT_LENGTH);
+}
+
+Number LazyReal::add(const Number& a, const Number& b)
+{
+    NumberKernel::Limbs x = a.toLimbs();
+    NumberKernel::Limbs y = b.toLimbs();
+    if (a.isNegative == b.isNegative)
+    {
+        return Number::fromLimbs(NumberKernel::add(x, y, LIMB_BASE), 0, a.isNegative, DEFAULT_LENGTH);
+    }
+    if (NumberKernel::compare(x, y) >= 0)
+    {
+        return Number::fromLimbs(NumberKernel::subtract(x, y, LIMB_BASE), 0, a.isNegative, DEFAULT_LENGTH);
+    }
+    return Number::fromLimbs(NumberKernel::subtract(y, x, LIMB_BASE), 0, b.isNegative, DEFAULT_LENGTH);
+}
+
+Number LazyReal::divideRound(const Number& a, const Number& b)
+{
+    NumberKernel::Limbs x = a.toLimbs();
+    NumberKernel::Limbs y = b.toLimbs();
+    if (x.size() == 0)
+    {
+        return Number();
+    }
+    x = NumberKernel::add(NumberKernel::multiplySmall(x, 2, LIMB_BASE), y, LIMB_BASE);
+    y = NumberKernel::multiplySmall(y, 2, LIMB_BASE);
+    NumberKernel::Limbs quotient;
+    NumberKernel::divide(x, y, LIMB_BASE, &quotient, nullptr);
+    return Number::fromLimbs(quotient, 0, a.isNegative != b.isNegative, DEFAULT_LENGTH);
+}
+
+Number LazyReal::isqrt(const Number& n)
+{
+    NumberKernel::Limbs a = n.toLimbs();
+    if (a.size() == 0)
+    {
+        return Number();
+    }
+    // Start above the root, then Newton's method decreases monotonically to floor(sqrt(n))
+    NumberKernel::Limbs x = Number(1).toLimbs((n.primary.size() + 1) / 2);
+    while (true)
+    {
+        NumberKernel::Limbs quotient;
+        NumberKernel::divide(a, x, LIMB_BASE, &quotient, nullptr);
+        NumberKernel::Limbs y = NumberKernel::divideSmall(NumberKernel::add(x, quotient, LIMB_BASE), 2, LIMB_BASE, nullptr);
+        if (NumberKernel::compare(y, x) >= 0)
+        {
+            break;
+        }
+        x = y;
+    }
+    return Number::fromLimbs(x, 0, false, DEFAULT_LENGTH);
+}
+
+void LazyReal::arctan(uint32_t k, size_t precision, NumberKernel::Limbs& positive, NumberKernel::Limbs& negative)
+{
+    // term = floor(10^precision / k^(2n+1)), flooring twice is the same as flooring once
+    NumberKernel::Limbs term = NumberKernel::divideSmall(Number(1).toLimbs(precision), k, LIMB_BASE, nullptr);
+    positive.clear();
+    negative.clear();
+    for (uint32_t n = 0; term.size() > 0; n++)
+    {
+        NumberKernel::Limbs t = NumberKernel::divideSmall(term, 2 * n + 1, LIMB_BASE, nullptr);
+        NumberKernel::addShifted(n % 2 == 0 ? positive : negative, t, 0, LIMB_BASE);
+        term = NumberKernel::divideSmall(term, (uint64_t)k * k, LIMB_BASE, nullptr);
+    }
+}
+
+Number LazyReal::approximatePi(size_t precision)
+{
+    Number cached;
+    size_t cachedPrecision = 0;
+    {
+        std::lock_guard<std::mutex> lock(piMutex);
+        cached = piValue;
+        cachedPrecision = piPrecision;
+    }
+    if (cachedPrecision >= precision && cachedPrecision > 0)
+    {
+        // Rounding a better approximation still keeps the error below 1
+        return scale(cached, -(long)(cachedPrecision - precision), true);
+    }
+    // Calculated without the lock, so other threads are not blocked, the more precise result is kept
+    Number result = calculatePi(precision);
+    std::lock_guard<std::mutex> lock(piMutex);
+    if (precision > piPrecision)
+    {
+        piPrecision = precision;
+        piValue = result;
+    }
+    return result;
+}
+
+Number LazyReal::calculatePi(size_t precision)
+{
+    // pi = 16 * atan(1/5) - 4 * atan(1/239), each term loses less than 2 units, the guard digits cover them
+    size_t guard = 2;
+    for (size_t t = 100 * (precision + 10); t > 0; t /= 10)
+    {
+        guard++;
+    }
+    NumberKernel::Limbs positive5;
+    NumberKernel::Limbs negative5;
+    NumberKernel::Limbs positive239;
+    NumberKernel::Limbs negative239;
+    arctan(5, precision + guard, positive5, negative5);
+    arctan(239, precision + guard, positive239, negative239);
+    NumberKernel::Limbs plus = NumberKernel::add(NumberKernel::multiplySmall(positive5, 16, LIMB_BASE), NumberKernel::multiplySmall(negative239, 4, LIMB_BASE), LIMB_BASE);
+    NumberKernel::Limbs minus = NumberKernel::add(NumberKernel::multiplySmall(negative5, 16, LIMB_BASE), NumberKernel::multiplySmall(positive239, 4, LIMB_BASE), LIMB_BASE);
+    Number result = Number::fromLimbs(NumberKernel::subtract(plus, minus, LIMB_BASE), 0, false, DEFAULT_LENGTH);
+    return scale(result, -(long)guard, true);
+}
+
+size_t LazyReal::integerDigits(Node& node)
+{
+    if (node.integerDigits == 0)
+    {
+        // |x| < |A| + 1 for the approximation A at precision 0
+        Number a = approximate(node, 0);
+        a.isNegative = false;
+        node.integerDigits = add(a, Number(1)).primary.size();
+    }
+    return node.integerDigits;
+}
+
+size_t LazyReal::leadingZeros(Node& node)
+{
+    if (node.hasLeadingZeros == false)
+    {
+        // |A| >= 2 at precision q means |x| > 10^-q
+        Number two(2);
+        size_t q = 0;
+        while (true)
+        {
+            Number a = approximate(node, q);
+            if (a >= two || a <= -two)
+            {
+                break;
+            }
+            if (q >= LAZY_REAL_ZERO_PRECISION)
+            {
+                throw std::domain_error("LazyReal: division by zero");
+            }
+            q = q == 0 ? 1 : q * 2;
+        }
+        node.leadingZeros = q;
+        node.hasLeadingZeros = true;
+    }
+    return node.leadingZeros;
+}
+
+Number LazyReal::approximate(Node& node, size_t precision)
+{
+    if (node.isCached && node.cachedPrecision >= precision)
+    {
+        // Rounding a better approximation still keeps the error below 1
+        if (node.cachedPrecision == precision)
+        {
+            return node.cache;
+        }
+        return scale(node.cache, -(long)(node.cachedPrecision - precision), true);
+    }
+    if (precision > LAZY_REAL_MAX_PRECISION)
+    {
+        throw std::domain_error("LazyReal: precision limit exceeded");
+    }
+    Number result;
+    switch (node.type)
+    {
+    case CONSTANT:
+        result = scale(node.value, (long)precision, true);
+        break;
+    case ADD:
+        // Errors of both children are below 0.1 at one more digit
+        result = scale(add(approximate(*node.left, precision + 1), approximate(*node.right, precision + 1)), -1, true);
+        break;
+    case NEGATE:
+        result = -approximate(*node.left, precision);
+        break;
+    case MULTIPLY:
+    {
+        // Each factor needs enough digits to cover the magnitude of the other one
+        size_t leftDigits = integerDigits(*node.left);
+        size_t rightDigits = integerDigits(*node.right);
+        Number a = approximate(*node.left, precision + rightDigits + 2);
+        Number b = approximate(*node.right, precision + leftDigits + 2);
+        result = scale(a * b, -(long)(precision + leftDigits + rightDigits + 4), true);
+        break;
+    }
+    case INVERSE:
+    {
+        // |x| >= 10^-q, so the error of 1/x grows by at most 10^2q
+        size_t q = leadingZeros(*node.left);
+        size_t extended = precision + 2 * q + 2;
+        Number a = approximate(*node.left, extended);
+        result = divideRound(scale(Number(1), (long)(precision + extended), false), a);
+        break;
+    }
+    case SQRT:
+    {
+        Number a = approximate(*node.left, 2 * precision + 2);
+        if (a.isNegative)
+        {
+            if (a <= Number(-2))
+            {
+                throw std::domain_error("LazyReal: square root of a negative number");
+            }
+            // Cannot be told from zero at this precision
+            a = Number();
+        }
+        result = scale(isqrt(a), -1, true);
+        break;
+    }
+    case PI:
+        result = approximatePi(precision);
+        break;
+    }
+    node.isCached = true;
+    node.cachedPrecision = precision;
+    node.cache = result;
+    return result;
+}
+
+LazyReal::LazyReal() : LazyReal(CONSTANT, nullptr, nullptr)
+{
+}
+
+LazyReal::LazyReal(int n) : LazyReal(CONSTANT, nullptr, nullptr)
+{
+    this->node->value = Number(n);
+}
+
+LazyReal::LazyReal(const Number& n) : LazyReal(CONSTANT, nullptr, nullptr)
+{
+    this->node->value = n;
+}
+
+LazyReal::LazyReal(const std::string& n) : LazyReal(CONSTANT, nullptr, nullptr)
+{
+    this->node->value = Number(n);
+}
+
+LazyReal LazyReal::pi()
+{
+    return LazyReal(PI, nullptr, nullptr);
+}
+
+LazyReal LazyReal::sqrt(const LazyReal& x)
+{
+    return LazyReal(SQRT, x.node, nullptr);
+}
+
+LazyReal LazyReal::operator - () const
+{
+    return LazyReal(NEGATE, this->node, nullptr);
+}
+
+LazyReal LazyReal::operator + (const LazyReal& x) const
+{
+    return LazyReal(ADD, this->node, x.node);
+}
+
+LazyReal LazyReal::operator - (const LazyReal& x) const
+{
+    return LazyReal(ADD, this->node, (-x).node);
+}
+
+LazyReal LazyReal::operator * (const LazyReal& x) const
+{
+    return LazyReal(MULTIPLY, this->node, x.node);
+}
+
+LazyReal LazyReal::operator / (const LazyReal& x) const
+{
+    return LazyReal(MULTIPLY, this->node, LazyReal(INVERSE, x.node, nullptr).node);
+}
+
+Number LazyReal::approximate(size_t precision) const
+{
+    return approximate(*this->node, precision);
+}
+
+Number LazyReal::toNumber(size_t precision) const
+{
+    Number a = this->approximate(precision);
+    return Number::fromLimbs(a.toLimbs(), precision, a.isNegative, precision > DEFAULT_LENGTH ? precision : DEFAULT_LENGTH);
+}
+
+std::string LazyReal::toString(size_t precision) const
+{
+    Number a = this->approximate(precision);
+    bool isNegative = a.isNegative;
+    a.isNegative = false;
+    std::string digits = (std::string)a;
+    if (digits.size() < precision + 1)
+    {
+        digits.insert(0, precision + 1 - digits.size(), '0');
+    }
+    if (precision > 0)
+    {
+        digits.insert(digits.size() - precision, 1, '.');
+    }
+    return isNegative ? "-" + digits : digits;
+}
+
+LazyReal::DigitIterator LazyReal::digits() const
+{
+    return DigitIterator(*this);
+}
+
+LazyReal::DigitIterator::DigitIterator(const LazyReal& x)
+{
+    this->node = x.node;
+    this->position = 0;
+    this->fractionDigits = 0;
+    // The sign is only printed when it can be proven, a value too close to zero is printed as 0.000...
+    Number two(2);
+    for (size_t q = 0; q <= LAZY_REAL_MAX_GUARD; q = q == 0 ? 1 : q * 2)
+    {
+        Number a = approximate(*this->node, q);
+        if (a >= two)
+        {
+            break;
+        }
+        if (a <= -two)
+        {
+            this->node = (-x).node;
+            this->pending = "-";
+            break;
+        }
+    }
+    // The integer part is decided like a block of fraction digits, but without an upper limit
+    for (size_t guard = 2; true; guard *= 2)
+    {
+        Number a = approximate(*this->node, guard);
+        Number low = scale(add(a, Number(-1)), -(long)guard, false);
+        Number high = scale(add(a, Number(1)), -(long)guard, false);
+        low = low.isNegative ? Number() : low;
+        high = high.isNegative ? Number() : high;
+        if (low == high || guard >= LAZY_REAL_MAX_GUARD)
+        {
+            this->emitted = low == high ? low : scale(a, -(long)guard, false);
+            this->emitted = this->emitted.isNegative ? Number() : this->emitted;
+            break;
+        }
+    }
+    this->pending += (std::string)this->emitted + ".";
+}
+
+void LazyReal::DigitIterator::refill()
+{
+    // Decide digits in blocks that grow with the output, so the approximations are refined geometrically
+    size_t count = this->fractionDigits > 16 ? this->fractionDigits : 16;
+    Number base = scale(this->emitted, (long)count, false);
+    Number limit = add(scale(Number(1), (long)count, false), Number(-1));
+    std::string low;
+    std::string high;
+    std::string middle;
+    for (size_t guard = 4; true; guard *= 2)
+    {
+        Number a = approximate(*this->node, this->fractionDigits + count + guard);
+        // floor(x * 10^(fractionDigits + count)) lies in [low, high], relative to the digits already emitted
+        Number candidates[3] = { add(a, Number(-1)), a, add(a, Number(1)) };
+        std::string* texts[3] = { &low, &middle, &high };
+        for (int i = 0; i < 3; i++)
+        {
+            Number digits = add(scale(candidates[i], -(long)guard, false), -base);
+            // A digit picked from one side earlier forces the rest of the expansion to all 0 or all 9
+            digits = digits.isNegative ? Number() : (digits > limit ? limit : digits);
+            *texts[i] = (std::string)digits;
+            texts[i]->insert(0, count - texts[i]->size(), '0');
+        }
+        size_t common = 0;
+        while (common < count && low[common] == high[common])
+        {
+            common++;
+        }
+        if (common == 0 && guard >= LAZY_REAL_MAX_GUARD)
+        {
+            // Undecidable within the guard limit, take the digit of the approximation itself
+            low = middle;
+            common = 1;
+        }
+        if (common > 0)
+        {
+            this->pending += low.substr(0, common);
+            this->emitted = add(scale(this->emitted, (long)common, false), Number(low.substr(0, common)));
+            this->fractionDigits += common;
+            return;
+        }
+    }
+}
+
+char LazyReal::DigitIterator::operator * ()
+{
+    if (this->position >= this->pending.size())
+    {
+        this->pending.clear();
+        this->position = 0;
+        this->refill();
+    }
+    return this->pending[this->position];
+}
+
+LazyReal::DigitIterator& LazyReal::DigitIterator::operator ++ ()
+{
+    if (this->position >= this->pending.size())
+    {
+        **this;
+    }
+    this->position++;
+    return *this;
+}
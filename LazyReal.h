@@ -0,0 +1,125 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include "Number.h"
+
+// Refinement throws std::domain_error once an approximation needs more digits than this
+#define LAZY_REAL_MAX_PRECISION 1000000
+// A divisor that cannot be told from zero with this many digits is treated as zero
+#define LAZY_REAL_ZERO_PRECISION 10000
+// Extra digits tried before the digit iterator gives up deciding a digit exactly, see DigitIterator
+#define LAZY_REAL_MAX_GUARD 64
+
+// Exact real number stored as an expression DAG, digits are calculated only when they are asked for
+// Every node can produce an integer A with |x * 10^p - A| < 1 for any precision p, and caches its best approximation
+// A later request with a lower precision is answered from the cache, a higher one refines the children as needed
+// Since a const instance may still update its caches, please lock the instance in a multi-thread environment
+class LazyReal
+{
+private:
+    enum NodeType
+    {
+        CONSTANT,
+        ADD,
+        NEGATE,
+        MULTIPLY,
+        INVERSE,
+        SQRT,
+        PI
+    };
+
+    struct Node
+    {
+        NodeType type;
+        std::shared_ptr<Node> left;
+        std::shared_ptr<Node> right;
+        // value of a CONSTANT node
+        Number value;
+        bool isCached;
+        size_t cachedPrecision;
+        // integer approximation at cachedPrecision
+        Number cache;
+        // |x| < 10^integerDigits, 0 if not calculated yet
+        size_t integerDigits;
+        // |x| >= 10^-leadingZeros, only valid if hasLeadingZeros is true
+        size_t leadingZeros;
+        bool hasLeadingZeros;
+    };
+
+    std::shared_ptr<Node> node;
+
+    LazyReal(NodeType type, const std::shared_ptr<Node>& left, const std::shared_ptr<Node>& right);
+
+    // Integer A with |x * 10^precision - A| < 1
+    static Number approximate(Node& node, size_t precision);
+    static size_t integerDigits(Node& node);
+    // Throw std::domain_error if the value cannot be told from zero within LAZY_REAL_ZERO_PRECISION digits
+    static size_t leadingZeros(Node& node);
+    // Pi from the shared cache, or calculated and stored in it if the cache is not precise enough
+    static Number approximatePi(size_t precision);
+    // Pi by Machin's formula
+    static Number calculatePi(size_t precision);
+    // atan(1 / k) * 10^precision, the positive and negative terms are summed separately
+    static void arctan(uint32_t k, size_t precision, NumberKernel::Limbs& positive, NumberKernel::Limbs& negative);
+
+    // n * 10^digits rounded to an integer, or truncated if isRounded is false
+    static Number scale(const Number& n, long digits, bool isRounded);
+    // Sum of two integers calculated on limbs
+    static Number add(const Number& a, const Number& b);
+    // a / b rounded to the nearest integer, b must not be zero
+    static Number divideRound(const Number& a, const Number& b);
+    // floor(sqrt(n)) by Newton's method, n must not be negative
+    static Number isqrt(const Number& n);
+
+public:
+    // Iterate the decimal expansion character by character: an optional '-', the integer digits, '.', then fraction digits forever
+    // A digit is only produced when the approximations prove it, so the iterator never has to take a digit back
+    // For values that sit exactly on a digit boundary, such as 0.5, this cannot be proven; after LAZY_REAL_MAX_GUARD extra
+    // digits the iterator picks one side and continues with the matching expansion, 0.5 may be printed as 0.4999...
+    class DigitIterator
+    {
+    private:
+        std::shared_ptr<Node> node;
+        // characters decided but not consumed yet
+        std::string pending;
+        size_t position;
+        // the digits produced so far as an integer, and the number of fraction digits in it
+        Number emitted;
+        size_t fractionDigits;
+
+        // Decide at least one more character
+        void refill();
+
+    public:
+        DigitIterator(const LazyReal& x);
+        char operator * ();
+        DigitIterator& operator ++ ();
+    };
+
+    LazyReal();
+    LazyReal(int n);
+    // The value of n is exact, its decimalLength does not matter
+    LazyReal(const Number& n);
+    LazyReal(const std::string& n);
+
+    // The constant pi, every call gives a new node, the digits of pi are shared by all of them behind a lock
+    static LazyReal pi();
+    // Square root, throw std::domain_error when refining a negative value
+    static LazyReal sqrt(const LazyReal& x);
+
+    LazyReal operator - () const;
+    LazyReal operator + (const LazyReal& x) const;
+    LazyReal operator - (const LazyReal& x) const;
+    LazyReal operator * (const LazyReal& x) const;
+    // Throw std::domain_error when refining if x cannot be told from zero within LAZY_REAL_ZERO_PRECISION digits
+    LazyReal operator / (const LazyReal& x) const;
+
+    // Integer A with |x * 10^precision - A| < 1
+    Number approximate(size_t precision) const;
+    // Value with precision digits after the decimal point, the last digit may be off by one
+    Number toNumber(size_t precision) const;
+    std::string toString(size_t precision) const;
+    // Start streaming the decimal expansion
+    DigitIterator digits() const;
+};
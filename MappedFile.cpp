@@ -0,0 +1,178 @@
+#include "MappedFile.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+{
+    this->mappedAddress = nullptr;
+    this->mappedLength = 0;
+    this->address = nullptr;
+    this->length = 0;
+    this->writable = false;
+#ifdef _WIN32
+    this->file = INVALID_HANDLE_VALUE;
+    this->mapping = NULL;
+#else
+    this->file = -1;
+#endif
+}
+
+MappedFile::MappedFile(const std::string& path) : MappedFile()
+{
+    this->open(path);
+}
+
+MappedFile::~MappedFile()
+{
+    this->close();
+}
+
+bool MappedFile::open(const std::string& path)
+{
+    // Get the file size first
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA attribute;
+    if (GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &attribute) == FALSE)
+    {
+        this->close();
+        return false;
+    }
+    uint64_t fileSize = ((uint64_t)attribute.nFileSizeHigh << 32) | attribute.nFileSizeLow;
+#else
+    struct stat status;
+    if (stat(path.c_str(), &status) < 0)
+    {
+        this->close();
+        return false;
+    }
+    uint64_t fileSize = (uint64_t)status.st_size;
+#endif
+    return this->open(path, 0, (size_t)fileSize, false);
+}
+
+bool MappedFile::open(const std::string& path, uint64_t offset, size_t length, bool writable)
+{
+    this->close();
+    this->writable = writable;
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    uint64_t alignedOffset = offset - offset % info.dwAllocationGranularity;
+    this->file = CreateFileA(path.c_str(), writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (this->file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    if (length == 0)
+    {
+        return true;
+    }
+    this->mapping = CreateFileMappingA(this->file, NULL, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, NULL);
+    if (this->mapping == NULL)
+    {
+        this->close();
+        return false;
+    }
+    this->mappedLength = (size_t)(offset - alignedOffset) + length;
+    this->mappedAddress = (unsigned char*)MapViewOfFile(this->mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, (DWORD)(alignedOffset >> 32), (DWORD)alignedOffset, this->mappedLength);
+#else
+    uint64_t pageSize = (uint64_t)sysconf(_SC_PAGESIZE);
+    uint64_t alignedOffset = offset - offset % pageSize;
+    this->file = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+    if (this->file < 0)
+    {
+        return false;
+    }
+    if (length == 0)
+    {
+        return true;
+    }
+    this->mappedLength = (size_t)(offset - alignedOffset) + length;
+    void* result = mmap(nullptr, this->mappedLength, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, this->file, (off_t)alignedOffset);
+    this->mappedAddress = result == MAP_FAILED ? nullptr : (unsigned char*)result;
+#endif
+    if (this->mappedAddress == nullptr)
+    {
+        this->close();
+        return false;
+    }
+    this->address = this->mappedAddress + (offset - alignedOffset);
+    this->length = length;
+    return true;
+}
+
+void MappedFile::close()
+{
+#ifdef _WIN32
+    if (this->mappedAddress != nullptr)
+    {
+        UnmapViewOfFile(this->mappedAddress);
+    }
+    if (this->mapping != NULL)
+    {
+        CloseHandle(this->mapping);
+    }
+    if (this->file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(this->file);
+    }
+    this->mapping = NULL;
+    this->file = INVALID_HANDLE_VALUE;
+#else
+    if (this->mappedAddress != nullptr)
+    {
+        munmap(this->mappedAddress, this->mappedLength);
+    }
+    if (this->file >= 0)
+    {
+        ::close(this->file);
+    }
+    this->file = -1;
+#endif
+    this->mappedAddress = nullptr;
+    this->mappedLength = 0;
+    this->address = nullptr;
+    this->length = 0;
+}
+
+bool MappedFile::isOpen() const
+{
+#ifdef _WIN32
+    return this->file != INVALID_HANDLE_VALUE;
+#else
+    return this->file >= 0;
+#endif
+}
+
+const unsigned char* MappedFile::data() const
+{
+    return this->address;
+}
+
+unsigned char* MappedFile::data()
+{
+    return this->address;
+}
+
+size_t MappedFile::size() const
+{
+    return this->length;
+}
+
+bool MappedFile::flush()
+{
+    if (this->mappedAddress == nullptr || this->writable == false)
+    {
+        return true;
+    }
+#ifdef _WIN32
+    return FlushViewOfFile(this->mappedAddress, this->mappedLength) != FALSE;
+#else
+    return msync(this->mappedAddress, this->mappedLength, MS_SYNC) == 0;
+#endif
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+// Memory mapping of a file or a range of a file, the mapping is released when the instance is destroyed
+class MappedFile
+{
+private:
+    // the mapping starts at an aligned offset, address points to the requested range inside it
+    unsigned char* mappedAddress;
+    size_t mappedLength;
+    unsigned char* address;
+    size_t length;
+    bool writable;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#else
+    int file;
+#endif
+
+public:
+    MappedFile();
+    // Map the whole file read only, see open()
+    MappedFile(const std::string& path);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator = (const MappedFile&) = delete;
+
+    // Map the whole file read only, the previous mapping will be closed, return false if the file cannot be mapped
+    bool open(const std::string& path);
+    // Map [offset, offset + length) of the file, the file must be long enough, return false if the range cannot be mapped
+    bool open(const std::string& path, uint64_t offset, size_t length, bool writable);
+    // Release the mapping, modified pages of a writable mapping are written back by the system
+    void close();
+    // An empty range can be opened but has no data
+    bool isOpen() const;
+    // Address of the first byte of the range, nullptr if nothing is mapped
+    const unsigned char* data() const;
+    // Address of the first byte of the range, do not write to it unless the mapping is writable
+    unsigned char* data();
+    // Size of the mapped range in bytes
+    size_t size() const;
+    // Write modified pages back to the file now, return false if failed
+    bool flush();
+};
@@ -1,7 +1,13 @@
 #include "Number.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
 
 void Number::adjustDigits()
 {
+    NUMBER_COUNT_NORMALIZATION();
     if (this->primary.size() == 0)
     {
         this->primary.push_back(0);
@@ -22,15 +28,15 @@ void Number::adjustDigits()
                 this->decimal[i] = (this->decimal[i] % 10);
             }
         }
-        // Adjust decimal point
+        // Adjust decimal point, the carry goes to the lowest integer digit
         if (this->decimal[0] < 0)
         {
-            this->primary[0] -= ((-this->decimal[0]) / 10 + 1);
+            this->primary.back() -= ((-this->decimal[0]) / 10 + 1);
             this->decimal[0] = (10 - ((-this->decimal[0]) % 10));
         }
         if (this->decimal[0] >= 10)
         {
-            this->primary[0] += (this->decimal[0] / 10);
+            this->primary.back() += (this->decimal[0] / 10);
             this->decimal[0] = (this->decimal[0] % 10);
         }
     }
@@ -92,10 +98,267 @@ void Number::adjustDigits()
     {
         this->decimal.pop_back();
     }
+    // zero is always positive
+    if (this->isZero())
+    {
+        this->isNegative = false;
+    }
+    this->resetHash();
+}
+
+bool Number::isZero() const
+{
+    for (int digit : this->primary)
+    {
+        if (digit != 0)
+        {
+            return false;
+        }
+    }
+    for (int digit : this->decimal)
+    {
+        if (digit != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Number::resetHash()
+{
+    this->hashValue.store(0, std::memory_order_relaxed);
+}
+
+void Number::setZero()
+{
+    this->isNegative = false;
+    this->primary.clear();
+    this->decimal.clear();
+    this->decimalLength = DEFAULT_LENGTH;
+    this->resetHash();
+}
+
+uint64_t Number::hashDigits(const int* digits, size_t size, uint64_t seed)
+{
+    // Independent lanes let the compiler vectorize the main loop
+    uint64_t lanes[NUMBER_HASH_LANES];
+    for (size_t k = 0; k < NUMBER_HASH_LANES; k++)
+    {
+        lanes[k] = seed + k * 0x9E3779B97F4A7C15ULL;
+    }
+    size_t i = 0;
+    for (; i + NUMBER_HASH_LANES <= size; i += NUMBER_HASH_LANES)
+    {
+        for (size_t k = 0; k < NUMBER_HASH_LANES; k++)
+        {
+            lanes[k] = (lanes[k] ^ (uint64_t)(uint32_t)digits[i + k]) * 0x100000001B3ULL;
+        }
+    }
+    for (size_t k = 0; i < size; i++, k++)
+    {
+        lanes[k] = (lanes[k] ^ (uint64_t)(uint32_t)digits[i]) * 0x100000001B3ULL;
+    }
+    uint64_t result = size;
+    for (size_t k = 0; k < NUMBER_HASH_LANES; k++)
+    {
+        result = mix(result ^ lanes[k]);
+    }
+    return result;
+}
+
+uint64_t Number::mix(uint64_t x)
+{
+    // Finalizer of splitmix64
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+int Number::compareMagnitude(const Number& a, const Number& b)
+{
+    size_t primarySize = a.primary.size() > b.primary.size() ? a.primary.size() : b.primary.size();
+    // compare primary part
+    for (size_t i = primarySize; i > 0; i--)
+    {
+        int x = i <= a.primary.size() ? a.primary[a.primary.size() - i] : 0;
+        int y = i <= b.primary.size() ? b.primary[b.primary.size() - i] : 0;
+        if (x != y)
+        {
+            return x < y ? -1 : 1;
+        }
+    }
+    // compare decimal part
+    for (size_t i = 0; i < a.decimal.size() || i < b.decimal.size(); i++)
+    {
+        int x = i < a.decimal.size() ? a.decimal[i] : 0;
+        int y = i < b.decimal.size() ? b.decimal[i] : 0;
+        if (x != y)
+        {
+            return x < y ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+NumberKernel::Limbs Number::toLimbs(size_t shift) const
+{
+    NumberKernel::Limbs result;
+    size_t totalDigits = this->primary.size() + this->decimal.size();
+    result.reserve((totalDigits + shift) / LIMB_DIGITS + 1);
+    // Full zero limbs created by the shift
+    result.assign(shift / LIMB_DIGITS, 0);
+    uint32_t limb = 0;
+    uint32_t power = 1;
+    for (size_t i = 0; i < shift % LIMB_DIGITS; i++)
+    {
+        power *= 10;
+    }
+    // Start from the last decimal digit
+    for (size_t i = totalDigits; i > 0; i--)
+    {
+        int digit = i - 1 < this->primary.size() ? this->primary[i - 1] : this->decimal[i - 1 - this->primary.size()];
+        limb += digit * power;
+        power *= 10;
+        if (power == LIMB_BASE)
+        {
+            result.push_back(limb);
+            limb = 0;
+            power = 1;
+        }
+    }
+    if (limb > 0)
+    {
+        result.push_back(limb);
+    }
+    NumberKernel::trim(result);
+    return result;
+}
+
+Number Number::fromLimbs(const NumberKernel::Limbs& limbs, size_t scale, bool isNegative, size_t decimalLength)
+{
+    // Unpack the limbs into digits, the highest digit first
+    std::vector<int> digits;
+    digits.reserve(limbs.size() * LIMB_DIGITS);
+    for (size_t i = limbs.size(); i > 0; i--)
+    {
+        uint32_t limb = limbs[i - 1];
+        for (uint32_t power = LIMB_BASE / 10; power > 0; power /= 10)
+        {
+            digits.push_back((int)(limb / power % 10));
+        }
+    }
+
+    Number result;
+    result.isNegative = isNegative;
+    result.decimalLength = decimalLength;
+    result.primary.clear();
+    size_t primaryDigits = digits.size() > scale ? digits.size() - scale : 0;
+    size_t start = 0;
+    while (start < primaryDigits && digits[start] == 0)
+    {
+        start++;
+    }
+    result.primary.assign(digits.begin() + start, digits.begin() + primaryDigits);
+    if (result.primary.size() == 0)
+    {
+        result.primary.push_back(0);
+    }
+    result.decimal.assign(scale > digits.size() ? scale - digits.size() : 0, 0);
+    result.decimal.insert(result.decimal.end(), digits.begin() + primaryDigits, digits.end());
+    if (result.decimal.size() > decimalLength)
+    {
+        result.decimal.resize(decimalLength);
+    }
+    while (result.decimal.size() > 0 && result.decimal[result.decimal.size() - 1] == 0)
+    {
+        result.decimal.pop_back();
+    }
+    if (result.primary.size() == 1 && result.primary[0] == 0 && result.decimal.size() == 0)
+    {
+        result.isNegative = false;
+    }
+    return result;
+}
+
+NumberKernel::Limbs Number::oddFactorial(unsigned int n, const std::vector<unsigned int>& primes)
+{
+    // oddFactorial(n) = oddFactorial(n / 2)^2 * swing(n), swing(n) is the odd part of n! / ((n / 2)!)^2
+    if (n < 2)
+    {
+        return NumberKernel::Limbs(1, 1);
+    }
+    NumberKernel::Limbs half = oddFactorial(n / 2, primes);
+    // The exponent of p in swing(n) is the number of odd values among n / p, n / p^2, ...
+    std::vector<unsigned int> factors;
+    for (unsigned int p : primes)
+    {
+        if (p > n)
+        {
+            break;
+        }
+        if (p == 2)
+        {
+            continue;
+        }
+        unsigned int q = n;
+        unsigned int factor = 1;
+        while ((q /= p) > 0)
+        {
+            if (q & 1)
+            {
+                factor *= p;
+            }
+        }
+        if (factor > 1)
+        {
+            factors.push_back(factor);
+        }
+    }
+    return NumberKernel::multiply(NumberKernel::multiply(half, half, LIMB_BASE), productOfFactors(factors), LIMB_BASE);
+}
+
+std::vector<unsigned int> Number::sieve(unsigned int n)
+{
+    std::vector<unsigned int> primes;
+    std::vector<bool> isComposite((size_t)n + 1, false);
+    for (size_t i = 2; i <= n; i++)
+    {
+        if (isComposite[i])
+        {
+            continue;
+        }
+        primes.push_back((unsigned int)i);
+        for (size_t j = i * i; j <= n; j += i)
+        {
+            isComposite[j] = true;
+        }
+    }
+    return primes;
+}
+
+NumberKernel::Limbs Number::productOfFactors(const std::vector<unsigned int>& factors)
+{
+    // Pack neighbouring factors into a single machine word before building the tree
+    std::vector<NumberKernel::Limbs> items;
+    NumberKernel::Limbs one(1, 1);
+    uint64_t word = 1;
+    for (unsigned int factor : factors)
+    {
+        if (word * factor > UINT32_MAX)
+        {
+            items.push_back(NumberKernel::multiplySmall(one, word, LIMB_BASE));
+            word = 1;
+        }
+        word *= factor;
+    }
+    items.push_back(NumberKernel::multiplySmall(one, word, LIMB_BASE));
+    return NumberKernel::product(items, LIMB_BASE);
 }
 
 Number::Number()
 {
+    NUMBER_COUNT_OPERATION(CONSTRUCT, 1);
     this->isNegative = false;
     this->decimalLength = DEFAULT_LENGTH;
     this->primary.push_back(0);
@@ -103,6 +366,7 @@ Number::Number()
 
 Number::Number(int n)
 {
+    NUMBER_COUNT_OPERATION(CONSTRUCT, 10);
     this->decimalLength = DEFAULT_LENGTH;
     if (n < 0)
     {
@@ -120,10 +384,15 @@ Number::Number(int n)
         this->primary.insert(this->primary.begin(), a);
         n /= 10;
     }
+    if (this->primary.size() == 0)
+    {
+        this->primary.push_back(0);
+    }
 }
 
 Number::Number(double n)
 {
+    NUMBER_COUNT_OPERATION(CONSTRUCT, 10);
     this->decimalLength = DEFAULT_LENGTH;
     if (n < 0)
     {
@@ -144,6 +413,10 @@ Number::Number(double n)
         this->primary.insert(this->primary.begin(), a);
         integerPart /= 10;
     }
+    if (this->primary.size() == 0)
+    {
+        this->primary.push_back(0);
+    }
 
     while (this->decimal.size() < this->decimalLength && decimalPart > 0)
     {
@@ -156,6 +429,7 @@ Number::Number(double n)
 
 Number::Number(std::string n)
 {
+    NUMBER_COUNT_OPERATION(CONSTRUCT, n.size());
     if (n[0] == '-')
     {
         this->isNegative = true;
@@ -188,32 +462,75 @@ Number::Number(std::string n)
     this->adjustDigits();
 }
 
+Number::Number(bool isNegative, const int* primary, size_t primarySize, const int* decimal, size_t decimalSize)
+{
+    NUMBER_COUNT_OPERATION(CONSTRUCT, primarySize + decimalSize);
+    this->isNegative = isNegative;
+    this->primary.assign(primary, primary + primarySize);
+    this->decimal.assign(decimal, decimal + decimalSize);
+    this->decimalLength = decimalSize > DEFAULT_LENGTH ? decimalSize : DEFAULT_LENGTH;
+    this->adjustDigits();
+}
+
 Number::Number(const Number& n)
 {
+    NUMBER_COUNT_OPERATION(COPY, n.primary.size() + n.decimal.size());
     this->isNegative = n.isNegative;
     this->primary = n.primary;
     this->decimal = n.decimal;
     this->decimalLength = n.decimalLength;
+    this->hashValue.store(n.hashValue.load(std::memory_order_relaxed), std::memory_order_relaxed);
 }
 
 Number& Number::operator = (const Number& n)
 {
+    NUMBER_COUNT_OPERATION(COPY, n.primary.size() + n.decimal.size());
     this->isNegative = n.isNegative;
     this->primary = n.primary;
     this->decimal = n.decimal;
     this->decimalLength = n.decimalLength;
+    this->hashValue.store(n.hashValue.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    return *this;
+}
+
+Number::Number(Number&& n) noexcept
+{
+    this->isNegative = n.isNegative;
+    this->primary = std::move(n.primary);
+    this->decimal = std::move(n.decimal);
+    this->decimalLength = n.decimalLength;
+    this->hashValue.store(n.hashValue.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    n.setZero();
+}
+
+Number& Number::operator = (Number&& n) noexcept
+{
+    if (this == &n)
+    {
+        return *this;
+    }
+    this->isNegative = n.isNegative;
+    // n takes the old buffers, they are freed with n
+    this->primary.swap(n.primary);
+    this->decimal.swap(n.decimal);
+    this->decimalLength = n.decimalLength;
+    this->hashValue.store(n.hashValue.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    n.setZero();
     return *this;
 }
 
 Number Number::operator - () const
 {
+    NUMBER_COUNT_OPERATION(NEGATE, this->primary.size() + this->decimal.size());
     Number result = *this;
-    result.isNegative = (!result.isNegative);
+    result.isNegative = (!result.isNegative) && (!result.isZero());
+    result.resetHash();
     return result;
 }
 
 Number Number::operator + (const Number& n) const
 {
+    NUMBER_COUNT_OPERATION(ADD, this->primary.size() + this->decimal.size() + n.primary.size() + n.decimal.size());
     Number result;
     result.primary.clear();
     result.decimalLength = this->decimalLength > n.decimalLength ? this->decimalLength : n.decimalLength;
@@ -252,6 +569,7 @@ Number Number::operator + (const Number& n) const
 
 Number Number::operator - (const Number& n) const 
 {
+    NUMBER_COUNT_OPERATION(SUBTRACT, this->primary.size() + this->decimal.size() + n.primary.size() + n.decimal.size());
     Number result;
     result.primary.clear();
     result.decimalLength = this->decimalLength > n.decimalLength ? this->decimalLength : n.decimalLength;
@@ -299,11 +617,62 @@ Number Number::operator - (const Number& n) const
     return result;
 }
 
+Number Number::operator * (const Number& n) const
+{
+    NUMBER_COUNT_OPERATION(MULTIPLY, this->primary.size() + this->decimal.size() + n.primary.size() + n.decimal.size());
+    size_t decimalLength = this->decimalLength > n.decimalLength ? this->decimalLength : n.decimalLength;
+    NumberKernel::Limbs limbs = NumberKernel::multiply(this->toLimbs(), n.toLimbs(), LIMB_BASE);
+    return fromLimbs(limbs, this->decimal.size() + n.decimal.size(), this->isNegative != n.isNegative, decimalLength);
+}
+
+Number Number::operator / (const Number& n) const
+{
+    NUMBER_COUNT_OPERATION(DIVIDE, this->primary.size() + this->decimal.size() + n.primary.size() + n.decimal.size());
+    // a * 10^-da / (b * 10^-db) = (a * 10^(length + db - da) / b) * 10^-length
+    NumberKernel::Limbs divisor = n.toLimbs();
+    if (divisor.size() == 0)
+    {
+        throw std::domain_error("Number: division by zero");
+    }
+    size_t decimalLength = this->decimalLength > n.decimalLength ? this->decimalLength : n.decimalLength;
+    size_t shift = decimalLength + n.decimal.size();
+    NumberKernel::Limbs dividend;
+    if (shift >= this->decimal.size())
+    {
+        dividend = this->toLimbs(shift - this->decimal.size());
+    }
+    else
+    {
+        dividend = this->toLimbs();
+        divisor = n.toLimbs(this->decimal.size() - shift);
+    }
+    NumberKernel::Limbs quotient;
+    NumberKernel::divide(dividend, divisor, LIMB_BASE, &quotient, nullptr);
+    return fromLimbs(quotient, decimalLength, this->isNegative != n.isNegative, decimalLength);
+}
+
+Number Number::operator % (const Number& n) const
+{
+    NUMBER_COUNT_OPERATION(MODULO, this->primary.size() + this->decimal.size() + n.primary.size() + n.decimal.size());
+    // Align both operands to the same scale, then the remainder has the same scale
+    size_t scale = this->decimal.size() > n.decimal.size() ? this->decimal.size() : n.decimal.size();
+    NumberKernel::Limbs divisor = n.toLimbs(scale - n.decimal.size());
+    if (divisor.size() == 0)
+    {
+        throw std::domain_error("Number: division by zero");
+    }
+    size_t decimalLength = this->decimalLength > n.decimalLength ? this->decimalLength : n.decimalLength;
+    NumberKernel::Limbs remainder;
+    NumberKernel::divide(this->toLimbs(scale - this->decimal.size()), divisor, LIMB_BASE, nullptr, &remainder);
+    return fromLimbs(remainder, scale, this->isNegative, decimalLength);
+}
+
 bool Number::operator == (const Number& n) const
 {
+    NUMBER_COUNT_OPERATION(COMPARE, this->primary.size() + this->decimal.size() + n.primary.size() + n.decimal.size());
     if (this->isNegative != n.isNegative)
     {
-        return false;
+        return this->isZero() && n.isZero();
     }
     for (size_t i = 0; i < n.primary.size() || i < this->primary.size(); i++)
     {
@@ -333,56 +702,13 @@ bool Number::operator != (const Number& n) const
 
 bool Number::operator < (const Number& n) const
 {
-    if (this->isNegative == false && n.isNegative == false)
-    {
-        size_t primarySize = this->primary.size() > n.primary.size() ? this->primary.size() : n.primary.size();
-        // compare primary part
-        for (size_t i = primarySize - 1; true; i--)
-        {
-            int a = i < this->primary.size() ? this->primary[this->primary.size() - i - 1] : 0;
-            int b = i < n.primary.size() ? n.primary[n.primary.size() - i - 1] : 0;
-            if (a < b)
-            {
-                return true;
-            }
-            else if (a > b)
-            {
-                return false;
-            }
-            if (i == 0)
-            {
-                break;
-            }
-        }
-        // compare decimal part
-        for (size_t i = 0; i < this->decimal.size() || i < n.decimal.size(); i++)
-        {
-            int a = i < this->decimal.size() ? this->decimal[i] : 0;
-            int b = i < n.decimal.size() ? n.decimal[i] : 0;
-            if (a < b)
-            {
-                return true;
-            }
-            else if (a > b)
-            {
-                return false;
-            }
-        }
-        // equal
-        return false;
-    }
-    else if (this->isNegative == true && n.isNegative == true)
-    {
-        return (-n) < (-(*this));
-    }
-    else if (this->isNegative == false && n.isNegative == true)
-    {
-        return false;
-    }
-    else
+    NUMBER_COUNT_OPERATION(COMPARE, this->primary.size() + this->decimal.size() + n.primary.size() + n.decimal.size());
+    if (this->isNegative != n.isNegative)
     {
-        return true;
+        return this->isNegative && !(this->isZero() && n.isZero());
     }
+    int result = compareMagnitude(*this, n);
+    return this->isNegative ? result > 0 : result < 0;
 }
 
 bool Number::operator > (const Number& n) const
@@ -402,6 +728,7 @@ bool Number::operator >= (const Number& n) const
 
 Number::operator int() const
 {
+    NUMBER_COUNT_OPERATION(CONVERT, this->primary.size() + this->decimal.size());
     int result = 0;
     for (size_t i = 0; i < this->primary.size(); i++)
     {
@@ -418,6 +745,7 @@ Number::operator int() const
 
 Number::operator double() const
 {
+    NUMBER_COUNT_OPERATION(CONVERT, this->primary.size() + this->decimal.size());
     double result = 0;
     for (size_t i = 0; i < this->primary.size(); i++)
     {
@@ -434,22 +762,470 @@ Number::operator double() const
 
 Number::operator std::string() const
 {
-    std::string result;
+    std::string result(this->getTextLength(), '\0');
+    this->writeText(&result[0]);
+    return result;
+}
+
+size_t Number::getTextLength() const
+{
+    // Empty integer digits are written as 0
+    size_t primarySize = this->primary.size() > 0 ? this->primary.size() : 1;
+    return (this->isNegative ? 1 : 0) + primarySize + (this->decimal.size() > 0 ? this->decimal.size() + 1 : 0);
+}
+
+char* Number::writeText(char* buffer) const
+{
+    NUMBER_COUNT_OPERATION(CONVERT, this->primary.size() + this->decimal.size());
     if (this->isNegative)
     {
-        result += "-";
+        *buffer++ = '-';
+    }
+    if (this->primary.size() == 0)
+    {
+        *buffer++ = '0';
     }
     for (size_t i = 0; i < this->primary.size(); i++)
     {
-        result += std::to_string(this->primary[i]);
+        *buffer++ = (char)('0' + this->primary[i]);
     }
     if (this->decimal.size() > 0)
     {
-        result += ".";
+        *buffer++ = '.';
         for (size_t i = 0; i < this->decimal.size(); i++)
         {
-            result += std::to_string(this->decimal[i]);
+            *buffer++ = (char)('0' + this->decimal[i]);
+        }
+    }
+    return buffer;
+}
+
+size_t Number::hash() const
+{
+    size_t result = this->hashValue.load(std::memory_order_relaxed);
+    if (result != 0)
+    {
+        return result;
+    }
+    // Hash the canonical form: no leading integer zeros, no ending decimal zeros, zero is positive
+    size_t first = 0;
+    while (first < this->primary.size() && this->primary[first] == 0)
+    {
+        first++;
+    }
+    size_t decimalSize = this->decimal.size();
+    while (decimalSize > 0 && this->decimal[decimalSize - 1] == 0)
+    {
+        decimalSize--;
+    }
+    size_t primarySize = this->primary.size() - first;
+    bool isNegative = this->isNegative && (primarySize > 0 || decimalSize > 0);
+    uint64_t value = hashDigits(this->primary.data() + first, primarySize, isNegative ? 1 : 0);
+    value = mix(value ^ hashDigits(this->decimal.data(), decimalSize, value));
+    result = (size_t)value;
+    // 0 means the hash is not calculated yet
+    result = result == 0 ? 1 : result;
+    this->hashValue.store(result, std::memory_order_relaxed);
+    return result;
+}
+
+// Largest power of base which is not greater than RADIX_LIMB_BASE, and its exponent
+static uint64_t radixLimb(unsigned int base, size_t* digits)
+{
+    uint64_t limb = base;
+    *digits = 1;
+    while (limb * base <= RADIX_LIMB_BASE)
+    {
+        limb *= base;
+        (*digits)++;
+    }
+    return limb;
+}
+
+std::string Number::toString(unsigned int base, bool isUpperCase) const
+{
+    if (base < 2 || base > 36)
+    {
+        throw std::domain_error("Number: base must be in [2, 36]");
+    }
+    if (this->decimal.size() > 0)
+    {
+        throw std::domain_error("Number: only integers can be converted to another base");
+    }
+    NUMBER_COUNT_OPERATION(CONVERT, this->primary.size());
+    const char* symbols = isUpperCase ? "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ" : "0123456789abcdefghijklmnopqrstuvwxyz";
+    size_t digits;
+    uint64_t limbBase = radixLimb(base, &digits);
+    // A power of two base is read bit by bit from the binary limbs, which RADIX_LIMB_BASE is a power of
+    bool isPowerOfTwo = (base & (base - 1)) == 0;
+    NumberKernel::Limbs limbs = NumberKernel::convert(this->toLimbs(), LIMB_BASE, isPowerOfTwo ? RADIX_LIMB_BASE : limbBase);
+    // Digits from the lowest one
+    std::string result;
+    if (isPowerOfTwo)
+    {
+        int bits = 0;
+        while ((1u << bits) < base)
+        {
+            bits++;
+        }
+        size_t totalBits = limbs.size() * 16;
+        for (size_t position = 0; position < totalBits; position += bits)
+        {
+            unsigned int digit = 0;
+            for (int i = 0; i < bits && position + i < totalBits; i++)
+            {
+                digit |= ((limbs[(position + i) / 16] >> ((position + i) % 16)) & 1) << i;
+            }
+            result += symbols[digit];
+        }
+    }
+    else
+    {
+        result.reserve(limbs.size() * digits + 1);
+        for (uint32_t limb : limbs)
+        {
+            for (size_t i = 0; i < digits; i++)
+            {
+                result += symbols[limb % base];
+                limb /= base;
+            }
         }
     }
+    while (result.size() > 1 && result.back() == '0')
+    {
+        result.pop_back();
+    }
+    if (result.size() == 0)
+    {
+        result = "0";
+    }
+    if (this->isNegative && result != "0")
+    {
+        result += '-';
+    }
+    return std::string(result.rbegin(), result.rend());
+}
+
+bool Number::fromString(const std::string& text, unsigned int base, Number& result)
+{
+    if (base < 2 || base > 36)
+    {
+        return false;
+    }
+    size_t first = 0;
+    bool isNegative = false;
+    if (text.size() > 0 && (text[0] == '-' || text[0] == '+'))
+    {
+        isNegative = text[0] == '-';
+        first = 1;
+    }
+    if (first >= text.size())
+    {
+        return false;
+    }
+    // Digit values from the lowest one
+    std::vector<uint32_t> values(text.size() - first);
+    for (size_t i = first; i < text.size(); i++)
+    {
+        char c = text[i];
+        unsigned int value = 36;
+        if (c >= '0' && c <= '9')
+        {
+            value = c - '0';
+        }
+        else if (c >= 'a' && c <= 'z')
+        {
+            value = c - 'a' + 10;
+        }
+        else if (c >= 'A' && c <= 'Z')
+        {
+            value = c - 'A' + 10;
+        }
+        if (value >= base)
+        {
+            return false;
+        }
+        values[text.size() - 1 - i] = value;
+    }
+    size_t digits;
+    uint64_t limbBase = radixLimb(base, &digits);
+    NumberKernel::Limbs limbs((values.size() + digits - 1) / digits, 0);
+    for (size_t i = limbs.size() * digits; i-- > 0;)
+    {
+        limbs[i / digits] = limbs[i / digits] * base + (i < values.size() ? values[i] : 0);
+    }
+    NumberKernel::trim(limbs);
+    NUMBER_COUNT_OPERATION(CONVERT, values.size());
+    result = fromLimbs(NumberKernel::convert(limbs, limbBase, LIMB_BASE), 0, isNegative, DEFAULT_LENGTH);
+    return true;
+}
+
+std::vector<unsigned char> Number::toBytes(bool isBigEndian) const
+{
+    if (this->decimal.size() > 0)
+    {
+        throw std::domain_error("Number: only integers can be converted to bytes");
+    }
+    NUMBER_COUNT_OPERATION(CONVERT, this->primary.size());
+    NumberKernel::Limbs limbs = NumberKernel::convert(this->toLimbs(), LIMB_BASE, RADIX_LIMB_BASE);
+    std::vector<unsigned char> result(limbs.size() * 2);
+    for (size_t i = 0; i < limbs.size(); i++)
+    {
+        result[2 * i] = (unsigned char)limbs[i];
+        result[2 * i + 1] = (unsigned char)(limbs[i] >> 8);
+    }
+    while (result.size() > 0 && result.back() == 0)
+    {
+        result.pop_back();
+    }
+    if (isBigEndian)
+    {
+        std::reverse(result.begin(), result.end());
+    }
     return result;
-}
\ No newline at end of file
+}
+
+Number Number::fromBytes(const unsigned char* data, size_t size, bool isBigEndian)
+{
+    NUMBER_COUNT_OPERATION(CONVERT, size);
+    NumberKernel::Limbs limbs((size + 1) / 2, 0);
+    for (size_t i = 0; i < size; i++)
+    {
+        // Byte i from the lowest one
+        unsigned char byte = isBigEndian ? data[size - 1 - i] : data[i];
+        limbs[i / 2] |= (uint32_t)byte << (8 * (i % 2));
+    }
+    NumberKernel::trim(limbs);
+    return fromLimbs(NumberKernel::convert(limbs, RADIX_LIMB_BASE, LIMB_BASE), 0, false, DEFAULT_LENGTH);
+}
+
+Number Number::gcd(const Number& a, const Number& b)
+{
+    size_t scale = a.decimal.size() > b.decimal.size() ? a.decimal.size() : b.decimal.size();
+    size_t decimalLength = a.decimalLength > b.decimalLength ? a.decimalLength : b.decimalLength;
+    NumberKernel::Limbs result = NumberKernel::gcd(a.toLimbs(scale - a.decimal.size()), b.toLimbs(scale - b.decimal.size()), LIMB_BASE);
+    return fromLimbs(result, scale, false, decimalLength);
+}
+
+Number Number::factorial(unsigned int n)
+{
+    // n! = oddFactorial(n) * 2^(n - popcount(n))
+    std::vector<unsigned int> primes = sieve(n);
+    NumberKernel::Limbs result = oddFactorial(n, primes);
+    unsigned int twos = n;
+    for (unsigned int m = n; m > 0; m >>= 1)
+    {
+        twos -= (m & 1);
+    }
+    NumberKernel::Limbs power(1, 1);
+    NumberKernel::Limbs square(1, 2);
+    while (twos > 0)
+    {
+        if (twos & 1)
+        {
+            power = NumberKernel::multiply(power, square, LIMB_BASE);
+        }
+        twos >>= 1;
+        if (twos > 0)
+        {
+            square = NumberKernel::multiply(square, square, LIMB_BASE);
+        }
+    }
+    result = NumberKernel::multiply(result, power, LIMB_BASE);
+    return fromLimbs(result, 0, false, DEFAULT_LENGTH);
+}
+
+Number Number::binomial(unsigned int n, unsigned int k)
+{
+    if (k > n)
+    {
+        return Number();
+    }
+    // Kummer's theorem: the exponent of p is the number of borrows when subtracting k from n in base p
+    std::vector<unsigned int> primes = sieve(n);
+    std::vector<unsigned int> factors;
+    for (unsigned int p : primes)
+    {
+        unsigned int factor = 1;
+        for (uint64_t power = p; power <= n; power *= p)
+        {
+            if (n / power - k / power - (n - k) / power > 0)
+            {
+                factor *= p;
+            }
+        }
+        if (factor > 1)
+        {
+            factors.push_back(factor);
+        }
+    }
+    return fromLimbs(productOfFactors(factors), 0, false, DEFAULT_LENGTH);
+}
+
+Number Number::product(const std::vector<Number>& factors)
+{
+    return product(factors.begin(), factors.end());
+}
+// Column sums are carried before they could overflow: an addition adds at most (LIMB_BASE - 1)^2 to a column,
+// and half of the range is kept free so that the carries added while carrying cannot overflow either
+#define NUMBER_DOT_MAX_ADDITIONS (UINT64_MAX / 2 / ((uint64_t)(LIMB_BASE - 1) * (LIMB_BASE - 1)))
+
+// Carry the column sums in place, so every column is less than LIMB_BASE again
+static void carryColumns(std::vector<uint64_t>& sum)
+{
+    uint64_t carry = 0;
+    for (size_t i = 0; i < sum.size(); i++)
+    {
+        uint64_t t = sum[i] + carry;
+        sum[i] = t % LIMB_BASE;
+        carry = t / LIMB_BASE;
+    }
+    while (carry > 0)
+    {
+        sum.push_back(carry % LIMB_BASE);
+        carry /= LIMB_BASE;
+    }
+}
+
+void Number::accumulate(std::vector<uint64_t>* sums, uint64_t* additions, const Number& a, const Number& b, size_t scale)
+{
+    NumberKernel::Limbs x = a.toLimbs(scale - a.decimal.size() - b.decimal.size());
+    NumberKernel::Limbs y = b.toLimbs();
+    if (x.size() == 0 || y.size() == 0)
+    {
+        return;
+    }
+    std::vector<uint64_t>& sum = sums[a.isNegative != b.isNegative ? 1 : 0];
+    if (sum.size() < x.size() + y.size())
+    {
+        sum.resize(x.size() + y.size(), 0);
+    }
+    size_t shorter = x.size() < y.size() ? x.size() : y.size();
+    bool isConvolved = shorter < NumberKernel::getKaratsubaThreshold();
+    // A convolution adds up to shorter products to a column, a kernel product adds one limb
+    uint64_t count = isConvolved ? shorter : 1;
+    if (*additions + count > NUMBER_DOT_MAX_ADDITIONS)
+    {
+        carryColumns(sums[0]);
+        carryColumns(sums[1]);
+        *additions = 0;
+    }
+    *additions += count;
+    if (isConvolved)
+    {
+        // Short operands are convolved straight into the columns without carrying
+        for (size_t i = 0; i < x.size(); i++)
+        {
+            uint64_t xi = x[i];
+            uint64_t* column = sum.data() + i;
+            for (size_t j = 0; j < y.size(); j++)
+            {
+                column[j] += xi * y[j];
+            }
+        }
+    }
+    else
+    {
+        NumberKernel::Limbs p = NumberKernel::multiply(x, y, LIMB_BASE);
+        for (size_t i = 0; i < p.size(); i++)
+        {
+            sum[i] += p[i];
+        }
+    }
+}
+
+Number Number::resolve(std::vector<uint64_t>* sums, size_t scale, size_t decimalLength)
+{
+    NumberKernel::Limbs limbs[2];
+    for (int k = 0; k < 2; k++)
+    {
+        carryColumns(sums[k]);
+        limbs[k].assign(sums[k].begin(), sums[k].end());
+        NumberKernel::trim(limbs[k]);
+    }
+    if (NumberKernel::compare(limbs[0], limbs[1]) >= 0)
+    {
+        return fromLimbs(NumberKernel::subtract(limbs[0], limbs[1], LIMB_BASE), scale, false, decimalLength);
+    }
+    return fromLimbs(NumberKernel::subtract(limbs[1], limbs[0], LIMB_BASE), scale, true, decimalLength);
+}
+
+Number Number::fma(const Number& a, const Number& b, const Number& c)
+{
+    NUMBER_COUNT_OPERATION(MULTIPLY, a.primary.size() + a.decimal.size() + b.primary.size() + b.decimal.size());
+    NUMBER_COUNT_OPERATION(ADD, c.primary.size() + c.decimal.size());
+    size_t scale = a.decimal.size() + b.decimal.size();
+    scale = c.decimal.size() > scale ? c.decimal.size() : scale;
+    size_t decimalLength = a.decimalLength > b.decimalLength ? a.decimalLength : b.decimalLength;
+    decimalLength = c.decimalLength > decimalLength ? c.decimalLength : decimalLength;
+    std::vector<uint64_t> sums[2];
+    uint64_t additions = 0;
+    accumulate(sums, &additions, a, b, scale);
+    accumulate(sums, &additions, c, Number(1), scale);
+    return resolve(sums, scale, decimalLength);
+}
+
+Number Number::dot(const Number* a, const Number* b, size_t size)
+{
+    size_t scale = 0;
+    size_t decimalLength = DEFAULT_LENGTH;
+    for (size_t i = 0; i < size; i++)
+    {
+        NUMBER_COUNT_OPERATION(MULTIPLY, a[i].primary.size() + a[i].decimal.size() + b[i].primary.size() + b[i].decimal.size());
+        scale = a[i].decimal.size() + b[i].decimal.size() > scale ? a[i].decimal.size() + b[i].decimal.size() : scale;
+        decimalLength = a[i].decimalLength > decimalLength ? a[i].decimalLength : decimalLength;
+        decimalLength = b[i].decimalLength > decimalLength ? b[i].decimalLength : decimalLength;
+    }
+    // One part of the pairs per thread of the pool and the calling thread, the buffers are merged column by column
+    ThreadPool* pool = size >= NUMBER_DOT_PARALLEL_THRESHOLD ? NumberKernel::getPool() : nullptr;
+    size_t parts = pool != nullptr ? pool->size() + 1 : 1;
+    std::vector<std::vector<uint64_t>> sums(2 * parts);
+    std::vector<uint64_t> additions(parts, 0);
+    auto sumParts = [&](size_t begin, size_t end)
+    {
+        for (size_t t = begin; t < end; t++)
+        {
+            for (size_t i = size * t / parts; i < size * (t + 1) / parts; i++)
+            {
+                accumulate(&sums[2 * t], &additions[t], a[i], b[i], scale);
+            }
+        }
+    };
+    if (pool == nullptr)
+    {
+        sumParts(0, parts);
+    }
+    else
+    {
+        pool->parallelFor(0, parts, 1, sumParts);
+    }
+    for (size_t t = 1; t < parts; t++)
+    {
+        for (int k = 0; k < 2; k++)
+        {
+            std::vector<uint64_t>& target = sums[k];
+            std::vector<uint64_t>& source = sums[2 * t + k];
+            // Carried columns are less than LIMB_BASE, so adding them cannot overflow
+            carryColumns(source);
+            carryColumns(target);
+            if (target.size() < source.size())
+            {
+                target.resize(source.size(), 0);
+            }
+            for (size_t i = 0; i < source.size(); i++)
+            {
+                target[i] += source[i];
+            }
+        }
+    }
+    return resolve(sums.data(), scale, decimalLength);
+}
+
+Number Number::dot(const std::vector<Number>& a, const std::vector<Number>& b)
+{
+    if (a.size() != b.size())
+    {
+        throw std::domain_error("Number: dot product of vectors with different lengths");
+    }
+    return dot(a.data(), b.data(), a.size());
+}
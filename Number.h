@@ -2,32 +2,93 @@
 
 #include <vector>
 #include <string>
+#include <atomic>
+#include <functional>
+#include "NumberKernel.h"
+#include "NumberStats.h"
 
 #define DEFAULT_LENGTH 127
+// Digits are packed into base 10000 limbs before calling the kernel algorithms
+#define LIMB_DIGITS 4
+#define LIMB_BASE 10000
+// Radix conversions work on limbs of at most this base, the largest one NTT can multiply
+#define RADIX_LIMB_BASE 65536
+// Number of independent lanes used by the digit hash
+#define NUMBER_HASH_LANES 8
+// dot() splits the pairs across the threads of NumberKernel::setParallel() from this many pairs on
+#define NUMBER_DOT_PARALLEL_THRESHOLD 4096
 
 class Number
 {
+    friend class Rational;
+    friend class NumberView;
+    friend class NumberWriter;
+    friend class DiskNumber;
+    friend class NumberSort;
+    friend class LazyReal;
+    friend class NumberRandom;
+    friend class NumberColumn;
+    friend class BigInt;
+
 private:
     bool isNegative;
-    std::vector<int> primary;
-    std::vector<int> decimal;
+    // the allocator only counts allocations if NUMBER_INSTRUMENTATION is defined
+    // primary is empty after a move, which means zero
+    std::vector<int, NumberAllocator<int>> primary;
+    std::vector<int, NumberAllocator<int>> decimal;
     size_t decimalLength;
+    // cached result of hash(), 0 if not calculated yet
+    mutable std::atomic<size_t> hashValue{0};
 
+    // Carry digits, remove leading zeros and ending decimal zeros, make zero positive
     void adjustDigits();
+    bool isZero() const;
+    // Call after the digits or the sign are changed directly
+    void resetHash();
+    // Become a positive zero with the default decimal length and empty digits, it never allocates
+    void setZero();
+    // Multi-lane hash of a digit sequence
+    static uint64_t hashDigits(const int* digits, size_t size, uint64_t seed);
+    static uint64_t mix(uint64_t x);
+    // Compare |a| and |b| without copying, return -1, 0 or 1
+    static int compareMagnitude(const Number& a, const Number& b);
+    // Pack all digits (ignore the sign and the decimal point) into limbs, the lowest limb first, then multiply by 10^shift
+    NumberKernel::Limbs toLimbs(size_t shift = 0) const;
+    // Build a number from limbs, the last scale digits are the decimal part, extra decimal digits are truncated
+    static Number fromLimbs(const NumberKernel::Limbs& limbs, size_t scale, bool isNegative, size_t decimalLength);
+    // Odd part of n!, calculated recursively by the prime swing algorithm
+    static NumberKernel::Limbs oddFactorial(unsigned int n, const std::vector<unsigned int>& primes);
+    // All primes not greater than n
+    static std::vector<unsigned int> sieve(unsigned int n);
+    // Multiply small factors together with a product tree
+    static NumberKernel::Limbs productOfFactors(const std::vector<unsigned int>& factors);
+    // Add a * b * 10^(scale - decimal digits of a and b) to sums[0] if it is positive or to sums[1] if negative
+    // The sums are base LIMB_BASE columns without carries, see Number::dot()
+    static void accumulate(std::vector<uint64_t>* sums, uint64_t* additions, const Number& a, const Number& b, size_t scale);
+    // Signed difference of the column sums as a normalized Number
+    static Number resolve(std::vector<uint64_t>* sums, size_t scale, size_t decimalLength);
 
 public:
     Number();
     Number(int n);
     Number(double n);
     Number(std::string n);
+    // Build from raw digits, the highest digit first, digits out of range [0, 9] will be carried
+    Number(bool isNegative, const int* primary, size_t primarySize, const int* decimal, size_t decimalSize);
     Number(const Number& n);
+    // Take over the digits of n, n is left as zero
+    Number(Number&& n) noexcept;
 
     Number operator - () const;
     Number& operator = (const Number& n);
+    Number& operator = (Number&& n) noexcept;
     Number operator + (const Number& n) const;
     Number operator - (const Number& n) const;
-    // Number operator * (const Number& n) const;
-    // Number operator / (const Number& n) const;
+    Number operator * (const Number& n) const;
+    // Keep decimalLength digits after the decimal point, throw std::domain_error if n is zero
+    Number operator / (const Number& n) const;
+    // Remainder of the truncated division, it has the same sign as *this, throw std::domain_error if n is zero
+    Number operator % (const Number& n) const;
     bool operator == (const Number& n) const;
     bool operator != (const Number& n) const;
     bool operator < (const Number& n) const;
@@ -38,4 +99,181 @@ public:
     operator int() const;
     operator double() const;
     operator std::string() const;
-};
\ No newline at end of file
+    // Number of characters of the text given by operator std::string()
+    size_t getTextLength() const;
+    // Write the text of operator std::string() to buffer without allocating, buffer must hold getTextLength() characters, return the end of the text
+    char* writeText(char* buffer) const;
+
+    // Hash of the value, equal numbers have the same hash regardless of leading zeros, ending decimal zeros or the sign of zero
+    // The hash is calculated once and cached in the instance
+    size_t hash() const;
+
+    // Radix conversion, only integers can be converted
+    // Digits in base 2 to 36 with a leading '-' if negative, throw std::domain_error if the number is not an integer or the base is invalid
+    std::string toString(unsigned int base, bool isUpperCase = false) const;
+    // Parse digits in base 2 to 36 with an optional sign, letters are not case-sensitive, return false if the text or the base is invalid
+    static bool fromString(const std::string& text, unsigned int base, Number& result);
+    // Magnitude as bytes without leading zero bytes, zero gives no bytes, throw std::domain_error if the number is not an integer
+    std::vector<unsigned char> toBytes(bool isBigEndian = true) const;
+    // Non-negative integer from a byte array
+    static Number fromBytes(const unsigned char* data, size_t size, bool isBigEndian = true);
+
+    // Greatest common divisor, for decimals it is the largest number that divides both of them a whole number of times
+    static Number gcd(const Number& a, const Number& b);
+
+    // Combinatorics
+    // Calculate n! with the prime swing algorithm
+    static Number factorial(unsigned int n);
+    // Calculate n choose k from its prime factorization, return 0 if k > n
+    static Number binomial(unsigned int n, unsigned int k);
+    // Multiply all numbers in the range together with a balanced product tree
+    template <typename Iterator>
+    static Number product(Iterator first, Iterator last);
+    // Multiply all numbers in the vector together with a balanced product tree
+    static Number product(const std::vector<Number>& factors);
+
+    // Exact weighted sums, the products are added up in one wide buffer of column sums which is normalized once at the end
+    // Calculate a * b + c with a single normalization
+    static Number fma(const Number& a, const Number& b, const Number& c);
+    // Sum of a[i] * b[i] for i in [0, size), each part of the pairs run on the kernel thread pool keeps its own buffer
+    static Number dot(const Number* a, const Number* b, size_t size);
+    // Sum of a[i] * b[i], throw std::domain_error if the vectors have different lengths
+    static Number dot(const std::vector<Number>& a, const std::vector<Number>& b);
+};
+
+template <typename Iterator>
+Number Number::product(Iterator first, Iterator last)
+{
+    std::vector<NumberKernel::Limbs> items;
+    size_t scale = 0;
+    size_t decimalLength = DEFAULT_LENGTH;
+    bool isNegative = false;
+    bool isZero = false;
+    for (; first != last; ++first)
+    {
+        const Number& n = *first;
+        items.push_back(n.toLimbs());
+        scale += n.decimal.size();
+        decimalLength = n.decimalLength > decimalLength ? n.decimalLength : decimalLength;
+        isNegative = (isNegative != n.isNegative);
+        isZero = isZero || items.back().size() == 0;
+    }
+    if (isZero)
+    {
+        return Number();
+    }
+    return fromLimbs(NumberKernel::product(items, LIMB_BASE), scale, isNegative, decimalLength);
+}
+
+namespace std
+{
+    template <>
+    struct hash<Number>
+    {
+        size_t operator () (const Number& n) const
+        {
+            return n.hash();
+        }
+    };
+}
+
+// Compile-time parser used by the "_num" literal
+class NumberLiteral
+{
+public:
+    template <size_t N>
+    struct Digits
+    {
+        int value[N > 0 ? N : 1];
+    };
+
+    // Only digits, digit separators and at most one decimal point are accepted
+    static constexpr bool isValid(const char* text, size_t size)
+    {
+        bool hasDot = false;
+        bool hasDigit = false;
+        for (size_t i = 0; i < size; i++)
+        {
+            if (text[i] >= '0' && text[i] <= '9')
+            {
+                hasDigit = true;
+            }
+            else if (text[i] == '.' && hasDot == false)
+            {
+                hasDot = true;
+            }
+            else if (text[i] != '\'')
+            {
+                return false;
+            }
+        }
+        return hasDigit;
+    }
+
+    // Count the digits of the integer part without leading zeros, or the decimal part without ending zeros
+    static constexpr size_t countDigits(const char* text, size_t size, bool isDecimal)
+    {
+        size_t count = 0;
+        size_t significant = 0;
+        bool isDecimalPart = false;
+        for (size_t i = 0; i < size; i++)
+        {
+            if (text[i] == '.')
+            {
+                isDecimalPart = true;
+            }
+            else if (text[i] >= '0' && text[i] <= '9' && isDecimalPart == isDecimal)
+            {
+                if (isDecimal || count > 0 || text[i] != '0')
+                {
+                    count++;
+                }
+                if (text[i] != '0' || isDecimal == false)
+                {
+                    significant = count;
+                }
+            }
+        }
+        return significant;
+    }
+
+    // Copy the digits counted by countDigits
+    template <size_t N>
+    static constexpr Digits<N> parseDigits(const char* text, size_t size, bool isDecimal)
+    {
+        Digits<N> result = {};
+        size_t count = 0;
+        bool isDecimalPart = false;
+        for (size_t i = 0; i < size && count < N; i++)
+        {
+            if (text[i] == '.')
+            {
+                isDecimalPart = true;
+            }
+            else if (text[i] >= '0' && text[i] <= '9' && isDecimalPart == isDecimal)
+            {
+                if (isDecimal || count > 0 || text[i] != '0')
+                {
+                    result.value[count] = text[i] - '0';
+                    count++;
+                }
+            }
+        }
+        return result;
+    }
+};
+
+// Number literal such as 123.456_num, the text is parsed at compile time and the Number is built once per literal
+// The result refers to static storage, copy it if you need a modifiable Number
+template <char... Chars>
+const Number& operator "" _num()
+{
+    static constexpr char text[] = { Chars... };
+    static_assert(NumberLiteral::isValid(text, sizeof(text)), "Number literal can only contain digits and at most one decimal point");
+    static constexpr size_t primarySize = NumberLiteral::countDigits(text, sizeof(text), false);
+    static constexpr size_t decimalSize = NumberLiteral::countDigits(text, sizeof(text), true);
+    static constexpr NumberLiteral::Digits<primarySize> primary = NumberLiteral::parseDigits<primarySize>(text, sizeof(text), false);
+    static constexpr NumberLiteral::Digits<decimalSize> decimal = NumberLiteral::parseDigits<decimalSize>(text, sizeof(text), true);
+    static const Number value(false, primary.value, primarySize, decimal.value, decimalSize);
+    return value;
+}
\ No newline at end of file
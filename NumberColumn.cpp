@@ -0,0 +1,449 @@
+#include "NumberColumn.h"
+
+#include "ThreadPool.h"
+
+#include <stdexcept>
+
+// The loops over the rows of a plane are kept free of branches, 64-bit values and possible aliasing, so the compiler can vectorize them
+
+// first = second or first = the other operand for the swapped rows (mask ~0), then the subtrahend is complemented (mask ~0)
+// to LIMB_BASE - 1 - limb, so a subtraction becomes an addition with an initial carry
+static void selectOperands(const uint32_t* __restrict x, const uint32_t* __restrict y, const uint32_t* __restrict swapMask, const uint32_t* __restrict complementMask,
+    uint32_t* __restrict first, uint32_t* __restrict second, size_t count)
+{
+    for (size_t r = 0; r < count; r++)
+    {
+        uint32_t difference = (x[r] ^ y[r]) & swapMask[r];
+        uint32_t other = y[r] ^ difference;
+        first[r] = x[r] ^ difference;
+        second[r] = other ^ ((other ^ (LIMB_BASE - 1 - other)) & complementMask[r]);
+    }
+}
+
+// z = first + second + carry, the carry of each row is 0 or 1
+static void addWithCarry(const uint32_t* __restrict first, const uint32_t* __restrict second, uint32_t* __restrict carry, uint32_t* __restrict z, size_t count)
+{
+    for (size_t r = 0; r < count; r++)
+    {
+        uint32_t t = first[r] + second[r] + carry[r];
+        uint32_t c = t >= LIMB_BASE ? 1 : 0;
+        carry[r] = c;
+        z[r] = t - (LIMB_BASE & (0 - c));
+    }
+}
+
+// Divide the planes from the highest one down by a constant divisor, so the division is done by multiplication
+template <uint32_t divisor>
+static void dividePlanes(uint32_t* limbs, size_t rows, size_t width, size_t begin, size_t end)
+{
+    std::vector<uint32_t> remainder(end - begin, 0);
+    uint32_t* __restrict rest = remainder.data();
+    for (size_t p = width; p-- > 0;)
+    {
+        uint32_t* __restrict z = limbs + p * rows + begin;
+        for (size_t r = 0; r < end - begin; r++)
+        {
+            uint32_t t = rest[r] * LIMB_BASE + z[r];
+            uint32_t q = t / divisor;
+            z[r] = q;
+            rest[r] = t - q * divisor;
+        }
+    }
+}
+
+NumberColumn::NumberColumn(size_t scale)
+{
+    this->scale = scale;
+    this->rows = 0;
+    this->width = 0;
+}
+
+NumberColumn::NumberColumn(const std::vector<Number>& numbers, size_t scale) : NumberColumn(scale)
+{
+    size_t width = 0;
+    for (const Number& n : numbers)
+    {
+        size_t limbs = (n.primary.size() + scale + LIMB_DIGITS - 1) / LIMB_DIGITS;
+        width = limbs > width ? limbs : width;
+    }
+    this->rows = numbers.size();
+    this->width = width;
+    this->limbs.assign(width * this->rows, 0);
+    this->lengths.assign(this->rows, 0);
+    this->negative.assign(this->rows, 0);
+    forRows(this->rows, [&](size_t begin, size_t end)
+    {
+        for (size_t r = begin; r < end; r++)
+        {
+            store(numbers[r], scale, this->limbs.data() + r, this->rows, width);
+            this->negative[r] = numbers[r].isNegative ? 1 : 0;
+        }
+        this->updateLengths(begin, end);
+    });
+    this->shrink();
+}
+
+void NumberColumn::forRows(size_t rows, const std::function<void(size_t, size_t)>& body)
+{
+    ThreadPool* pool = rows >= NUMBER_COLUMN_PARALLEL_THRESHOLD ? NumberKernel::getPool() : nullptr;
+    if (pool == nullptr)
+    {
+        body(0, rows);
+        return;
+    }
+    pool->parallelFor(0, rows, NUMBER_COLUMN_PARALLEL_GRAIN, body);
+}
+
+void NumberColumn::store(const Number& n, size_t scale, uint32_t* row, size_t stride, size_t width)
+{
+    // Digit i counts from the lowest digit of value * 10^scale, decimal digits beyond the scale are dropped
+    size_t primarySize = n.primary.size();
+    size_t totalDigits = primarySize + scale;
+    for (size_t p = 0; p < width; p++)
+    {
+        uint32_t limb = 0;
+        for (size_t k = LIMB_DIGITS; k-- > 0;)
+        {
+            size_t i = p * LIMB_DIGITS + k;
+            int digit = 0;
+            if (i < totalDigits)
+            {
+                size_t position = totalDigits - 1 - i;
+                if (position < primarySize)
+                {
+                    digit = n.primary[position];
+                }
+                else if (position - primarySize < n.decimal.size())
+                {
+                    digit = n.decimal[position - primarySize];
+                }
+            }
+            limb = limb * 10 + digit;
+        }
+        row[p * stride] = limb;
+    }
+}
+
+void NumberColumn::setWidth(size_t width)
+{
+    std::vector<uint32_t> resized(width * this->rows, 0);
+    size_t kept = width < this->width ? width : this->width;
+    std::copy(this->limbs.begin(), this->limbs.begin() + kept * this->rows, resized.begin());
+    this->limbs.swap(resized);
+    this->width = width;
+}
+
+void NumberColumn::updateLengths(size_t first, size_t last)
+{
+    uint32_t* lengths = this->lengths.data();
+    for (size_t r = first; r < last; r++)
+    {
+        lengths[r] = 0;
+    }
+    for (size_t p = 0; p < this->width; p++)
+    {
+        const uint32_t* limbs = this->limbs.data() + p * this->rows;
+        for (size_t r = first; r < last; r++)
+        {
+            lengths[r] = limbs[r] != 0 ? (uint32_t)(p + 1) : lengths[r];
+        }
+    }
+    uint8_t* negative = this->negative.data();
+    for (size_t r = first; r < last; r++)
+    {
+        negative[r] = lengths[r] != 0 ? negative[r] : 0;
+    }
+}
+
+void NumberColumn::shrink()
+{
+    size_t used = 0;
+    for (uint32_t length : this->lengths)
+    {
+        used = length > used ? length : used;
+    }
+    if (used < this->width)
+    {
+        this->setWidth(used);
+    }
+}
+
+const uint32_t* NumberColumn::plane(size_t index, const std::vector<uint32_t>& zeros) const
+{
+    return index < this->width ? this->limbs.data() + index * this->rows : zeros.data();
+}
+
+void NumberColumn::check(const NumberColumn& n) const
+{
+    if (this->scale != n.scale || this->rows != n.rows)
+    {
+        throw std::domain_error("NumberColumn: columns must have the same size and scale");
+    }
+}
+
+NumberColumn NumberColumn::combine(const NumberColumn& a, const NumberColumn& b, bool isSubtract)
+{
+    a.check(b);
+    NumberColumn result(a.scale);
+    size_t inputWidth = a.width > b.width ? a.width : b.width;
+    result.rows = a.rows;
+    result.width = inputWidth + 1;
+    result.limbs.assign(result.width * result.rows, 0);
+    result.lengths.assign(result.rows, 0);
+    result.negative.assign(result.rows, 0);
+    std::vector<uint32_t> zeros(a.rows, 0);
+    forRows(a.rows, [&](size_t begin, size_t end)
+    {
+        size_t count = end - begin;
+        // Compare the magnitudes from the highest plane down
+        std::vector<int8_t> order(count, 0);
+        for (size_t p = inputWidth; p-- > 0;)
+        {
+            const uint32_t* x = a.plane(p, zeros) + begin;
+            const uint32_t* y = b.plane(p, zeros) + begin;
+            for (size_t r = 0; r < count; r++)
+            {
+                int8_t difference = (int8_t)((x[r] > y[r]) - (x[r] < y[r]));
+                order[r] = order[r] != 0 ? order[r] : difference;
+            }
+        }
+        // Same signs add the magnitudes, different signs subtract the smaller one from the larger one
+        // A subtraction adds the complement of the smaller magnitude plus 1, the carry out of the top plane is dropped
+        std::vector<uint32_t> swapMask(count);
+        std::vector<uint32_t> complementMask(count);
+        std::vector<uint32_t> carry(count);
+        for (size_t r = 0; r < count; r++)
+        {
+            uint8_t bNegative = b.negative[begin + r] ^ (isSubtract ? 1 : 0);
+            bool isSame = a.negative[begin + r] == bNegative;
+            bool isSwapped = isSame == false && order[r] < 0;
+            swapMask[r] = isSwapped ? UINT32_MAX : 0;
+            complementMask[r] = isSame ? 0 : UINT32_MAX;
+            carry[r] = isSame ? 0 : 1;
+            result.negative[begin + r] = isSwapped ? bNegative : a.negative[begin + r];
+        }
+        std::vector<uint32_t> first(count);
+        std::vector<uint32_t> second(count);
+        for (size_t p = 0; p < result.width; p++)
+        {
+            selectOperands(a.plane(p, zeros) + begin, b.plane(p, zeros) + begin, swapMask.data(), complementMask.data(), first.data(), second.data(), count);
+            addWithCarry(first.data(), second.data(), carry.data(), result.limbs.data() + p * result.rows + begin, count);
+        }
+        result.updateLengths(begin, end);
+    });
+    result.shrink();
+    return result;
+}
+
+NumberColumn NumberColumn::multiplyLimbs(const NumberKernel::Limbs& factor) const
+{
+    NumberColumn result(this->scale);
+    result.rows = this->rows;
+    result.width = factor.size() > 0 && this->width > 0 ? this->width + factor.size() : 0;
+    result.limbs.assign(result.width * result.rows, 0);
+    result.lengths.assign(result.rows, 0);
+    result.negative = this->negative;
+    forRows(this->rows, [&](size_t begin, size_t end)
+    {
+        size_t count = end - begin;
+        std::vector<uint64_t> sum(count, 0);
+        for (size_t k = 0; k < result.width; k++)
+        {
+            // Plane k of the product collects limb i of the rows times limb k - i of the factor
+            size_t first = k + 1 > factor.size() ? k + 1 - factor.size() : 0;
+            size_t last = k < this->width ? k : this->width - 1;
+            for (size_t i = first; i <= last && i < this->width; i++)
+            {
+                uint64_t f = factor[k - i];
+                const uint32_t* x = this->limbs.data() + i * this->rows + begin;
+                for (size_t r = 0; r < count; r++)
+                {
+                    sum[r] += x[r] * f;
+                }
+            }
+            uint32_t* z = result.limbs.data() + k * result.rows + begin;
+            for (size_t r = 0; r < count; r++)
+            {
+                z[r] = (uint32_t)(sum[r] % LIMB_BASE);
+                sum[r] /= LIMB_BASE;
+            }
+        }
+        result.updateLengths(begin, end);
+    });
+    result.shrink();
+    return result;
+}
+
+void NumberColumn::truncateDigits(size_t digits)
+{
+    size_t planes = digits / LIMB_DIGITS;
+    if (planes >= this->width)
+    {
+        this->setWidth(0);
+        this->lengths.assign(this->rows, 0);
+        this->negative.assign(this->rows, 0);
+        return;
+    }
+    if (planes > 0)
+    {
+        std::copy(this->limbs.begin() + planes * this->rows, this->limbs.end(), this->limbs.begin());
+        this->limbs.resize((this->width - planes) * this->rows);
+        this->width -= planes;
+    }
+    forRows(this->rows, [&](size_t begin, size_t end)
+    {
+        // LIMB_DIGITS is 4, so the remaining digits are removed by dividing by 10, 100 or 1000
+        switch (digits % LIMB_DIGITS)
+        {
+        case 1:
+            dividePlanes<10>(this->limbs.data(), this->rows, this->width, begin, end);
+            break;
+        case 2:
+            dividePlanes<100>(this->limbs.data(), this->rows, this->width, begin, end);
+            break;
+        case 3:
+            dividePlanes<1000>(this->limbs.data(), this->rows, this->width, begin, end);
+            break;
+        }
+        this->updateLengths(begin, end);
+    });
+    this->shrink();
+}
+
+size_t NumberColumn::size() const
+{
+    return this->rows;
+}
+
+size_t NumberColumn::getScale() const
+{
+    return this->scale;
+}
+
+size_t NumberColumn::getWidth() const
+{
+    return this->width;
+}
+
+void NumberColumn::resize(size_t rows)
+{
+    std::vector<uint32_t> resized(this->width * rows, 0);
+    size_t kept = rows < this->rows ? rows : this->rows;
+    for (size_t p = 0; p < this->width; p++)
+    {
+        std::copy(this->limbs.begin() + p * this->rows, this->limbs.begin() + p * this->rows + kept, resized.begin() + p * rows);
+    }
+    this->limbs.swap(resized);
+    this->rows = rows;
+    this->lengths.resize(rows, 0);
+    this->negative.resize(rows, 0);
+}
+
+Number NumberColumn::get(size_t row) const
+{
+    NumberKernel::Limbs limbs(this->lengths[row]);
+    for (size_t p = 0; p < limbs.size(); p++)
+    {
+        limbs[p] = this->limbs[p * this->rows + row];
+    }
+    return Number::fromLimbs(limbs, this->scale, this->negative[row] != 0, this->scale > DEFAULT_LENGTH ? this->scale : DEFAULT_LENGTH);
+}
+
+void NumberColumn::set(size_t row, const Number& n)
+{
+    size_t limbs = (n.primary.size() + this->scale + LIMB_DIGITS - 1) / LIMB_DIGITS;
+    if (limbs > this->width)
+    {
+        this->setWidth(limbs);
+    }
+    store(n, this->scale, this->limbs.data() + row, this->rows, this->width);
+    this->negative[row] = n.isNegative ? 1 : 0;
+    this->updateLengths(row, row + 1);
+}
+
+std::vector<Number> NumberColumn::toNumbers() const
+{
+    std::vector<Number> result(this->rows);
+    forRows(this->rows, [&](size_t begin, size_t end)
+    {
+        for (size_t r = begin; r < end; r++)
+        {
+            result[r] = this->get(r);
+        }
+    });
+    return result;
+}
+
+NumberColumn NumberColumn::operator + (const NumberColumn& n) const
+{
+    return combine(*this, n, false);
+}
+
+NumberColumn NumberColumn::operator - (const NumberColumn& n) const
+{
+    return combine(*this, n, true);
+}
+
+std::vector<int8_t> NumberColumn::compare(const NumberColumn& n) const
+{
+    this->check(n);
+    std::vector<int8_t> result(this->rows, 0);
+    size_t width = this->width > n.width ? this->width : n.width;
+    std::vector<uint32_t> zeros(this->rows, 0);
+    forRows(this->rows, [&](size_t begin, size_t end)
+    {
+        int8_t* order = result.data() + begin;
+        for (size_t p = width; p-- > 0;)
+        {
+            const uint32_t* x = this->plane(p, zeros) + begin;
+            const uint32_t* y = n.plane(p, zeros) + begin;
+            for (size_t r = 0; r < end - begin; r++)
+            {
+                int8_t difference = (int8_t)((x[r] > y[r]) - (x[r] < y[r]));
+                order[r] = order[r] != 0 ? order[r] : difference;
+            }
+        }
+        // Zero is positive, so different signs decide alone
+        for (size_t r = 0; r < end - begin; r++)
+        {
+            uint8_t a = this->negative[begin + r];
+            uint8_t b = n.negative[begin + r];
+            order[r] = a != b ? (a ? -1 : 1) : (a ? (int8_t)-order[r] : order[r]);
+        }
+    });
+    return result;
+}
+
+NumberColumn NumberColumn::multiply(const Number& factor) const
+{
+    NumberColumn result = this->multiplyLimbs(factor.toLimbs());
+    if (factor.isNegative)
+    {
+        for (uint8_t& sign : result.negative)
+        {
+            sign ^= 1;
+        }
+    }
+    // Also clears the sign of zero rows
+    result.truncateDigits(factor.decimal.size());
+    return result;
+}
+
+NumberColumn NumberColumn::rescale(size_t scale) const
+{
+    if (scale >= this->scale)
+    {
+        NumberKernel::Limbs power(1, 1);
+        for (size_t i = this->scale; i < scale; i++)
+        {
+            power = NumberKernel::multiplySmall(power, 10, LIMB_BASE);
+        }
+        NumberColumn result = this->multiplyLimbs(power);
+        result.scale = scale;
+        return result;
+    }
+    NumberColumn result = *this;
+    result.truncateDigits(this->scale - scale);
+    result.scale = scale;
+    return result;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include "Number.h"
+
+// Element-wise operations split the rows across the threads of NumberKernel::setParallel() from this many rows on,
+// in chunks of at least NUMBER_COLUMN_PARALLEL_GRAIN rows
+#define NUMBER_COLUMN_PARALLEL_THRESHOLD 65536
+#define NUMBER_COLUMN_PARALLEL_GRAIN 16384
+
+// Column of numbers with a shared scale (number of decimal digits) stored as struct of arrays
+// The magnitudes are base LIMB_BASE integers (value * 10^scale) in one limb matrix stored plane by plane:
+// limb i of every row is contiguous, so the element-wise loops run across rows; the add, subtract and truncate loops are vectorized at -O3
+// Each row also has a sign and a length (significant limbs), zero is always positive
+// Digits beyond the scale are truncated when a Number is stored
+class NumberColumn
+{
+private:
+    size_t scale;
+    size_t rows;
+    // Number of limb planes
+    size_t width;
+    // limbs[plane * rows + row], the lowest plane first
+    std::vector<uint32_t> limbs;
+    std::vector<uint32_t> lengths;
+    std::vector<uint8_t> negative;
+
+    // Call body(begin, end) for chunks of rows, in parallel for long columns
+    static void forRows(size_t rows, const std::function<void(size_t, size_t)>& body);
+    // Change the number of planes, keeping the values that fit
+    void setWidth(size_t width);
+    // Recalculate lengths of rows [first, last), clear the sign of zero rows
+    void updateLengths(size_t first, size_t last);
+    // Drop planes which are zero in every row
+    void shrink();
+    // Write the magnitude of n times 10^scale into a row of width planes, the planes are stride limbs apart
+    static void store(const Number& n, size_t scale, uint32_t* row, size_t stride, size_t width);
+    // Pointer to a plane, or to zeros if the plane does not exist
+    const uint32_t* plane(size_t index, const std::vector<uint32_t>& zeros) const;
+    // a + b or a - b, row by row
+    static NumberColumn combine(const NumberColumn& a, const NumberColumn& b, bool isSubtract);
+    // Multiply every magnitude by the same limbs
+    NumberColumn multiplyLimbs(const NumberKernel::Limbs& factor) const;
+    // Remove the lowest digits, rounding toward zero
+    void truncateDigits(size_t digits);
+    // Throw std::domain_error unless n has the same scale and size
+    void check(const NumberColumn& n) const;
+
+public:
+    NumberColumn(size_t scale = 0);
+    NumberColumn(const std::vector<Number>& numbers, size_t scale);
+
+    // Number of rows
+    size_t size() const;
+    size_t getScale() const;
+    // Number of limbs of the longest value
+    size_t getWidth() const;
+    // Add or remove rows, new rows are zero
+    void resize(size_t rows);
+    Number get(size_t row) const;
+    void set(size_t row, const Number& n);
+    std::vector<Number> toNumbers() const;
+
+    // Element-wise arithmetic, the columns must have the same size and scale, otherwise std::domain_error is thrown
+    NumberColumn operator + (const NumberColumn& n) const;
+    NumberColumn operator - (const NumberColumn& n) const;
+    // -1, 0 or 1 for each row as *this is less than, equal to or greater than n
+    std::vector<int8_t> compare(const NumberColumn& n) const;
+    // Multiply every row by factor, the scale is kept and extra digits are truncated
+    NumberColumn multiply(const Number& factor) const;
+    // The same values with another scale, digits beyond a smaller scale are truncated
+    NumberColumn rescale(size_t scale) const;
+};
@@ -0,0 +1,518 @@
+#include "NumberExpression.h"
+
+#include <stdexcept>
+
+NumberExpression::NumberExpression()
+{
+    this->position = 0;
+    this->isCollecting = false;
+    this->result = 0;
+    this->errorPosition = 0;
+}
+
+NumberExpression::NumberExpression(const NumberExpression& n) : NumberExpression()
+{
+    *this = n;
+}
+
+NumberExpression& NumberExpression::operator = (const NumberExpression& n)
+{
+    this->variables = n.variables;
+    this->constants = n.constants;
+    this->program = n.program;
+    this->result = n.result;
+    this->registers = n.registers;
+    this->slots = n.slots;
+    this->error = n.error;
+    this->errorPosition = n.errorPosition;
+    this->bindRegisters();
+    return *this;
+}
+
+void NumberExpression::skipSpaces()
+{
+    while (this->position < this->formula.size() && (this->formula[this->position] == ' ' || this->formula[this->position] == '\t'))
+    {
+        this->position++;
+    }
+}
+
+size_t NumberExpression::fail(const std::string& message, size_t at)
+{
+    if (this->error.empty())
+    {
+        this->error = message;
+        this->errorPosition = at;
+    }
+    return SIZE_MAX;
+}
+
+size_t NumberExpression::addConstant(const Number& value)
+{
+    auto found = this->constantIndex.find(value);
+    if (found != this->constantIndex.end())
+    {
+        return this->addNode(CONSTANT, found->second, 0);
+    }
+    this->constants.push_back(value);
+    this->constantIndex[value] = this->constants.size() - 1;
+    return this->addNode(CONSTANT, this->constants.size() - 1, 0);
+}
+
+size_t NumberExpression::addNode(Opcode op, size_t left, size_t right)
+{
+    if (op != VARIABLE && op != CONSTANT)
+    {
+        bool isConstant = this->nodes[left].op == CONSTANT && (op == NEGATE || this->nodes[right].op == CONSTANT);
+        if (isConstant)
+        {
+            const Number& a = this->constants[this->nodes[left].left];
+            const Number& b = this->constants[this->nodes[op == NEGATE ? left : right].left];
+            switch (op)
+            {
+            case NEGATE:
+                return this->addConstant(-a);
+            case ADD:
+                return this->addConstant(a + b);
+            case SUBTRACT:
+                return this->addConstant(a - b);
+            case MULTIPLY:
+                return this->addConstant(a * b);
+            case DIVIDE:
+                return b == Number() ? this->fail("division by zero", this->position) : this->addConstant(a / b);
+            default:
+                return b == Number() ? this->fail("division by zero", this->position) : this->addConstant(a % b);
+            }
+        }
+        // a + b and b + a are the same sub-expression
+        if ((op == ADD || op == MULTIPLY) && right < left)
+        {
+            std::swap(left, right);
+        }
+    }
+    std::tuple<int, size_t, size_t> key(op, left, op == NEGATE || op == VARIABLE || op == CONSTANT ? 0 : right);
+    auto found = this->nodeIndex.find(key);
+    if (found != this->nodeIndex.end())
+    {
+        return found->second;
+    }
+    this->nodes.push_back({ op, left, std::get<2>(key) });
+    this->nodeIndex[key] = this->nodes.size() - 1;
+    return this->nodes.size() - 1;
+}
+
+size_t NumberExpression::parseSum()
+{
+    size_t left = this->parseProduct();
+    while (left != SIZE_MAX)
+    {
+        this->skipSpaces();
+        if (this->position >= this->formula.size() || (this->formula[this->position] != '+' && this->formula[this->position] != '-'))
+        {
+            break;
+        }
+        Opcode op = this->formula[this->position] == '+' ? ADD : SUBTRACT;
+        this->position++;
+        size_t right = this->parseProduct();
+        left = right == SIZE_MAX ? SIZE_MAX : this->addNode(op, left, right);
+    }
+    return left;
+}
+
+size_t NumberExpression::parseProduct()
+{
+    size_t left = this->parseUnary();
+    while (left != SIZE_MAX)
+    {
+        this->skipSpaces();
+        if (this->position >= this->formula.size())
+        {
+            break;
+        }
+        char c = this->formula[this->position];
+        if (c != '*' && c != '/' && c != '%')
+        {
+            break;
+        }
+        Opcode op = c == '*' ? MULTIPLY : (c == '/' ? DIVIDE : MODULO);
+        this->position++;
+        size_t right = this->parseUnary();
+        left = right == SIZE_MAX ? SIZE_MAX : this->addNode(op, left, right);
+    }
+    return left;
+}
+
+size_t NumberExpression::parseUnary()
+{
+    this->skipSpaces();
+    if (this->position < this->formula.size() && (this->formula[this->position] == '-' || this->formula[this->position] == '+'))
+    {
+        bool isNegate = this->formula[this->position] == '-';
+        this->position++;
+        size_t operand = this->parseUnary();
+        if (operand == SIZE_MAX || isNegate == false)
+        {
+            return operand;
+        }
+        // -(-x) is x
+        if (this->nodes[operand].op == NEGATE)
+        {
+            return this->nodes[operand].left;
+        }
+        return this->addNode(NEGATE, operand, 0);
+    }
+    return this->parsePrimary();
+}
+
+size_t NumberExpression::parsePrimary()
+{
+    this->skipSpaces();
+    if (this->position >= this->formula.size())
+    {
+        return this->fail("unexpected end of formula", this->position);
+    }
+    size_t start = this->position;
+    char c = this->formula[this->position];
+    if (c == '(')
+    {
+        this->position++;
+        size_t inner = this->parseSum();
+        this->skipSpaces();
+        if (inner != SIZE_MAX && (this->position >= this->formula.size() || this->formula[this->position] != ')'))
+        {
+            return this->fail("missing ')'", this->position);
+        }
+        this->position++;
+        return inner;
+    }
+    if ((c >= '0' && c <= '9') || c == '.')
+    {
+        bool hasDigit = false;
+        bool hasPoint = false;
+        while (this->position < this->formula.size())
+        {
+            c = this->formula[this->position];
+            if (c >= '0' && c <= '9')
+            {
+                hasDigit = true;
+            }
+            else if (c == '.' && hasPoint == false)
+            {
+                hasPoint = true;
+            }
+            else
+            {
+                break;
+            }
+            this->position++;
+        }
+        if (hasDigit == false)
+        {
+            return this->fail("invalid number", start);
+        }
+        return this->addConstant(Number(this->formula.substr(start, this->position - start)));
+    }
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_')
+    {
+        while (this->position < this->formula.size())
+        {
+            c = this->formula[this->position];
+            if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_')
+            {
+                this->position++;
+            }
+            else
+            {
+                break;
+            }
+        }
+        std::string name = this->formula.substr(start, this->position - start);
+        for (size_t i = 0; i < this->variables.size(); i++)
+        {
+            if (this->variables[i] == name)
+            {
+                return this->addNode(VARIABLE, i, 0);
+            }
+        }
+        if (this->isCollecting == false)
+        {
+            return this->fail("unknown variable '" + name + "'", start);
+        }
+        this->variables.push_back(name);
+        return this->addNode(VARIABLE, this->variables.size() - 1, 0);
+    }
+    return this->fail(std::string("unexpected '") + c + "'", start);
+}
+
+void NumberExpression::generate(size_t root)
+{
+    // Count the uses of every node reachable from the root, children always have lower indexes than their parents
+    std::vector<size_t> uses(this->nodes.size(), 0);
+    uses[root] = 1;
+    for (size_t i = this->nodes.size(); i-- > 0;)
+    {
+        const Node& node = this->nodes[i];
+        if (uses[i] > 0 && node.op != VARIABLE && node.op != CONSTANT)
+        {
+            uses[node.left]++;
+            if (node.op != NEGATE)
+            {
+                uses[node.right]++;
+            }
+        }
+    }
+    std::vector<Number> used;
+    for (size_t i = 0; i < this->nodes.size(); i++)
+    {
+        if (uses[i] > 0 && this->nodes[i].op == CONSTANT)
+        {
+            used.push_back(this->constants[this->nodes[i].left]);
+            this->nodes[i].left = used.size() - 1;
+        }
+    }
+    this->constants.swap(used);
+    uint32_t base = (uint32_t)(this->variables.size() + this->constants.size());
+    std::vector<uint32_t> slot(this->nodes.size(), 0);
+    std::vector<uint32_t> freeRegisters;
+    uint32_t registerCount = 0;
+    // Children come first, so emitting in index order is a valid evaluation order
+    for (size_t i = 0; i < this->nodes.size(); i++)
+    {
+        const Node& node = this->nodes[i];
+        if (uses[i] == 0)
+        {
+            continue;
+        }
+        if (node.op == VARIABLE)
+        {
+            slot[i] = (uint32_t)node.left;
+            continue;
+        }
+        if (node.op == CONSTANT)
+        {
+            slot[i] = (uint32_t)(this->variables.size() + node.left);
+            continue;
+        }
+        Instruction instruction = { node.op, 0, slot[node.left], node.op == NEGATE ? 0 : slot[node.right] };
+        // Release the registers of operands at their last use, the target may reuse one of them
+        size_t operands[2] = { node.left, node.right };
+        for (int k = 0; k < (node.op == NEGATE ? 1 : 2); k++)
+        {
+            size_t operand = operands[k];
+            if (--uses[operand] == 0 && slot[operand] >= base)
+            {
+                freeRegisters.push_back(slot[operand] - base);
+            }
+        }
+        if (freeRegisters.size() > 0)
+        {
+            instruction.target = freeRegisters.back();
+            freeRegisters.pop_back();
+        }
+        else
+        {
+            instruction.target = registerCount++;
+        }
+        slot[i] = base + instruction.target;
+        this->program.push_back(instruction);
+    }
+    this->result = slot[root];
+    this->registers.assign(registerCount, Number());
+    this->slots.assign(base + registerCount, nullptr);
+    this->bindRegisters();
+}
+
+void NumberExpression::bindRegisters()
+{
+    size_t base = this->variables.size();
+    if (this->slots.size() < base + this->constants.size() + this->registers.size())
+    {
+        return;
+    }
+    for (size_t i = 0; i < this->constants.size(); i++)
+    {
+        this->slots[base + i] = &this->constants[i];
+    }
+    base += this->constants.size();
+    for (size_t i = 0; i < this->registers.size(); i++)
+    {
+        this->slots[base + i] = &this->registers[i];
+    }
+}
+
+bool NumberExpression::compile(const std::string& formula, const std::vector<std::string>& variables)
+{
+    this->variables = variables;
+    this->constants.clear();
+    this->program.clear();
+    this->registers.clear();
+    this->slots.clear();
+    this->error.clear();
+    this->errorPosition = 0;
+    this->nodes.clear();
+    this->formula = formula;
+    this->position = 0;
+
+    size_t root = this->parseSum();
+    this->skipSpaces();
+    if (root != SIZE_MAX && this->position < this->formula.size())
+    {
+        root = this->fail(std::string("unexpected '") + this->formula[this->position] + "'", this->position);
+    }
+    if (root != SIZE_MAX)
+    {
+        this->generate(root);
+    }
+    this->nodes.clear();
+    this->nodeIndex.clear();
+    this->constantIndex.clear();
+    this->formula.clear();
+    this->isCollecting = false;
+    if (root == SIZE_MAX)
+    {
+        this->constants.clear();
+        return false;
+    }
+    return true;
+}
+
+bool NumberExpression::compile(const std::string& formula)
+{
+    this->isCollecting = true;
+    return this->compile(formula, std::vector<std::string>());
+}
+
+const std::string& NumberExpression::getError() const
+{
+    return this->error;
+}
+
+size_t NumberExpression::getErrorPosition() const
+{
+    return this->errorPosition;
+}
+
+const std::vector<std::string>& NumberExpression::getVariables() const
+{
+    return this->variables;
+}
+
+size_t NumberExpression::size() const
+{
+    return this->program.size();
+}
+
+std::string NumberExpression::disassemble() const
+{
+    size_t base = this->variables.size() + this->constants.size();
+    auto name = [this, base](uint32_t slot) -> std::string
+    {
+        if (slot < this->variables.size())
+        {
+            return this->variables[slot];
+        }
+        if (slot < base)
+        {
+            return (std::string)this->constants[slot - this->variables.size()];
+        }
+        return "r" + std::to_string(slot - base);
+    };
+    static const char* symbols[] = { "", "", "-", "+", "-", "*", "/", "%" };
+    std::string text;
+    for (const Instruction& instruction : this->program)
+    {
+        text += "r" + std::to_string(instruction.target) + " = ";
+        if (instruction.op == NEGATE)
+        {
+            text += "-" + name(instruction.left) + "\n";
+        }
+        else
+        {
+            text += name(instruction.left) + " " + symbols[instruction.op] + " " + name(instruction.right) + "\n";
+        }
+    }
+    if (this->slots.size() > 0)
+    {
+        text += "return " + name(this->result) + "\n";
+    }
+    return text;
+}
+
+const Number& NumberExpression::execute()
+{
+    const Number* const* slot = this->slots.data();
+    for (const Instruction& instruction : this->program)
+    {
+        Number& target = this->registers[instruction.target];
+        switch (instruction.op)
+        {
+        case NEGATE:
+            target = -*slot[instruction.left];
+            break;
+        case ADD:
+            target = *slot[instruction.left] + *slot[instruction.right];
+            break;
+        case SUBTRACT:
+            target = *slot[instruction.left] - *slot[instruction.right];
+            break;
+        case MULTIPLY:
+            target = *slot[instruction.left] * *slot[instruction.right];
+            break;
+        case DIVIDE:
+            target = *slot[instruction.left] / *slot[instruction.right];
+            break;
+        case MODULO:
+            target = *slot[instruction.left] % *slot[instruction.right];
+            break;
+        default:
+            break;
+        }
+    }
+    return *slot[this->result];
+}
+
+Number NumberExpression::evaluate(const std::vector<Number>& values)
+{
+    if (this->slots.size() == 0)
+    {
+        throw std::domain_error("NumberExpression: no formula compiled");
+    }
+    if (values.size() < this->variables.size())
+    {
+        throw std::domain_error("NumberExpression: missing variable values");
+    }
+    for (size_t i = 0; i < this->variables.size(); i++)
+    {
+        this->slots[i] = &values[i];
+    }
+    return this->execute();
+}
+
+void NumberExpression::evaluate(const std::vector<const std::vector<Number>*>& columns, std::vector<Number>& results)
+{
+    if (this->slots.size() == 0)
+    {
+        throw std::domain_error("NumberExpression: no formula compiled");
+    }
+    if (columns.size() < this->variables.size())
+    {
+        throw std::domain_error("NumberExpression: missing variable columns");
+    }
+    size_t rows = this->variables.size() > 0 ? columns[0]->size() : results.size();
+    for (size_t i = 0; i < this->variables.size(); i++)
+    {
+        if (columns[i]->size() != rows)
+        {
+            throw std::domain_error("NumberExpression: columns have different lengths");
+        }
+    }
+    results.resize(rows);
+    for (size_t row = 0; row < rows; row++)
+    {
+        for (size_t i = 0; i < this->variables.size(); i++)
+        {
+            this->slots[i] = &(*columns[i])[row];
+        }
+        results[row] = this->execute();
+    }
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <cstdint>
+#include "Number.h"
+
+// Formula compiled once into a register program and evaluated over many rows of Number values
+// Syntax: decimal literals, variable names ([A-Za-z_][A-Za-z0-9_]*), parentheses, unary + and -, and + - * / % with the usual precedence
+// Constant sub-expressions are calculated at compile time, and equal sub-expressions are calculated only once per row
+// Registers are reused between instructions and between rows, please use one instance per thread
+class NumberExpression
+{
+private:
+    enum Opcode
+    {
+        VARIABLE,
+        CONSTANT,
+        NEGATE,
+        ADD,
+        SUBTRACT,
+        MULTIPLY,
+        DIVIDE,
+        MODULO
+    };
+
+    // Node of the expression DAG built by the parser, VARIABLE and CONSTANT nodes keep their index in left
+    struct Node
+    {
+        Opcode op;
+        size_t left;
+        size_t right;
+    };
+
+    // Operands are slots: the variables first, then the constants, then the registers
+    struct Instruction
+    {
+        Opcode op;
+        uint32_t target;
+        uint32_t left;
+        uint32_t right;
+    };
+
+    // Compiler state, cleared after compile()
+    std::vector<Node> nodes;
+    // Index of every node by (op, left, right) and of every constant by value, to share equal ones
+    std::map<std::tuple<int, size_t, size_t>, size_t> nodeIndex;
+    std::unordered_map<Number, size_t> constantIndex;
+    std::string formula;
+    size_t position;
+    bool isCollecting;
+
+    // Program
+    std::vector<std::string> variables;
+    std::vector<Number> constants;
+    std::vector<Instruction> program;
+    uint32_t result;
+    std::vector<Number> registers;
+    std::vector<const Number*> slots;
+    std::string error;
+    size_t errorPosition;
+
+    // Recursive descent parser, return the node index or SIZE_MAX after an error
+    size_t parseSum();
+    size_t parseProduct();
+    size_t parseUnary();
+    size_t parsePrimary();
+    void skipSpaces();
+    size_t fail(const std::string& message, size_t at);
+    // Add a node, folding constants and sharing an equal existing node
+    size_t addNode(Opcode op, size_t left, size_t right);
+    size_t addConstant(const Number& value);
+    // Generate the program for the DAG rooted at root, registers are released after their last use
+    // Constants which were only used to fold others are dropped
+    void generate(size_t root);
+    // Point the register slots at the registers
+    void bindRegisters();
+    // Run the program once the variable slots are set
+    const Number& execute();
+
+public:
+    NumberExpression();
+    NumberExpression(const NumberExpression& n);
+    NumberExpression& operator = (const NumberExpression& n);
+
+    // Compile a formula, the value of variables[i] is passed at index i when evaluating, return false if the formula is invalid
+    bool compile(const std::string& formula, const std::vector<std::string>& variables);
+    // Compile a formula, the variables are numbered in the order they first appear, return false if the formula is invalid
+    bool compile(const std::string& formula);
+    // Message and character position of the last compile error, empty if there was none
+    const std::string& getError() const;
+    size_t getErrorPosition() const;
+    // Variable names in index order
+    const std::vector<std::string>& getVariables() const;
+    // Number of instructions after the optimization
+    size_t size() const;
+    // Readable listing of the program, one instruction per line
+    std::string disassemble() const;
+
+    // Evaluate one row, values[i] is the value of variable i, throw std::domain_error if there are too few values or on division by zero
+    Number evaluate(const std::vector<Number>& values);
+    // Evaluate every row of the columns, columns[i] holds the values of variable i, all columns must have the same length
+    // results is resized to the number of rows, throw std::domain_error if the columns do not match or on division by zero
+    void evaluate(const std::vector<const std::vector<Number>*>& columns, std::vector<Number>& results);
+};
@@ -0,0 +1,431 @@
+#include "NumberFile.h"
+
+#include <cstring>
+
+static const char NUMBER_FILE_MAGIC[8] = { 'C', 'P', 'P', 'U', 'N', 'U', 'M', '\0' };
+static const size_t NUMBER_FILE_HEADER_SIZE = 32;
+
+static uint32_t loadUint32(const unsigned char* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t loadUint64(const unsigned char* p)
+{
+    return (uint64_t)loadUint32(p) | ((uint64_t)loadUint32(p + 4) << 32);
+}
+
+static void storeUint32(unsigned char* p, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        p[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+static void storeUint64(unsigned char* p, uint64_t value)
+{
+    storeUint32(p, (uint32_t)value);
+    storeUint32(p + 4, (uint32_t)(value >> 32));
+}
+
+size_t NumberRecord::size(size_t totalDigits)
+{
+    return (NUMBER_RECORD_HEADER_SIZE + (totalDigits + 1) / 2 + 7) / 8 * 8;
+}
+
+void NumberRecord::writeHeader(unsigned char* record, bool isNegative, size_t decimalLength, size_t primarySize, size_t decimalSize)
+{
+    record[0] = isNegative ? 1 : 0;
+    storeUint32(record + 4, (uint32_t)decimalLength);
+    storeUint32(record + 8, (uint32_t)primarySize);
+    storeUint32(record + 12, (uint32_t)decimalSize);
+}
+
+bool NumberRecord::isCanonical(const unsigned char* record)
+{
+    size_t primarySize = loadUint32(record + 8);
+    size_t decimalSize = loadUint32(record + 12);
+    size_t totalDigits = primarySize + decimalSize;
+    const unsigned char* digits = record + NUMBER_RECORD_HEADER_SIZE;
+    auto digit = [digits](size_t i) { return (i % 2 == 0) ? (digits[i / 2] >> 4) : (digits[i / 2] & 0x0F); };
+    for (size_t i = 0; i < totalDigits; i++)
+    {
+        if (digit(i) > 9)
+        {
+            return false;
+        }
+    }
+    // The padding nibble of an odd number of digits is zero
+    if (totalDigits % 2 == 1 && (digits[totalDigits / 2] & 0x0F) != 0)
+    {
+        return false;
+    }
+    bool isZero = primarySize == 1 && digit(0) == 0 && decimalSize == 0;
+    if (record[0] > 1 || (record[0] == 1 && isZero))
+    {
+        return false;
+    }
+    if (primarySize == 0 || (primarySize > 1 && digit(0) == 0))
+    {
+        return false;
+    }
+    return decimalSize == 0 || digit(totalDigits - 1) != 0;
+}
+
+NumberView::NumberView(const unsigned char* record)
+{
+    this->record = record;
+}
+
+bool NumberView::isNegative() const
+{
+    return this->record[0] != 0;
+}
+
+size_t NumberView::primarySize() const
+{
+    return loadUint32(this->record + 8);
+}
+
+size_t NumberView::decimalSize() const
+{
+    return loadUint32(this->record + 12);
+}
+
+size_t NumberView::getDecimalLength() const
+{
+    return loadUint32(this->record + 4);
+}
+
+int NumberView::digit(size_t i) const
+{
+    unsigned char packed = this->record[NUMBER_RECORD_HEADER_SIZE + i / 2];
+    return (i % 2 == 0) ? (packed >> 4) : (packed & 0x0F);
+}
+
+int NumberView::compare(const NumberView& n) const
+{
+    // Zero is always stored as positive
+    if (this->isNegative() != n.isNegative())
+    {
+        return this->isNegative() ? -1 : 1;
+    }
+    int sign = this->isNegative() ? -1 : 1;
+    if (this->primarySize() != n.primarySize())
+    {
+        return this->primarySize() < n.primarySize() ? -sign : sign;
+    }
+    // Same integer length means the packed digits are aligned, missing digits and padding are both zero
+    size_t sizeA = (this->primarySize() + this->decimalSize() + 1) / 2;
+    size_t sizeB = (n.primarySize() + n.decimalSize() + 1) / 2;
+    const unsigned char* a = this->record + NUMBER_RECORD_HEADER_SIZE;
+    const unsigned char* b = n.record + NUMBER_RECORD_HEADER_SIZE;
+    int result = memcmp(a, b, sizeA < sizeB ? sizeA : sizeB);
+    if (result != 0)
+    {
+        return result < 0 ? -sign : sign;
+    }
+    for (size_t i = sizeB; i < sizeA; i++)
+    {
+        if (a[i] != 0)
+        {
+            return sign;
+        }
+    }
+    for (size_t i = sizeA; i < sizeB; i++)
+    {
+        if (b[i] != 0)
+        {
+            return -sign;
+        }
+    }
+    return 0;
+}
+
+bool NumberView::operator == (const NumberView& n) const
+{
+    return this->compare(n) == 0;
+}
+
+bool NumberView::operator != (const NumberView& n) const
+{
+    return this->compare(n) != 0;
+}
+
+bool NumberView::operator < (const NumberView& n) const
+{
+    return this->compare(n) < 0;
+}
+
+bool NumberView::operator > (const NumberView& n) const
+{
+    return this->compare(n) > 0;
+}
+
+bool NumberView::operator <= (const NumberView& n) const
+{
+    return this->compare(n) <= 0;
+}
+
+bool NumberView::operator >= (const NumberView& n) const
+{
+    return this->compare(n) >= 0;
+}
+
+Number NumberView::toNumber() const
+{
+    Number result;
+    size_t primarySize = this->primarySize();
+    size_t decimalSize = this->decimalSize();
+    result.isNegative = this->isNegative();
+    result.decimalLength = this->getDecimalLength();
+    result.primary.resize(primarySize);
+    result.decimal.resize(decimalSize);
+    for (size_t i = 0; i < primarySize; i++)
+    {
+        result.primary[i] = this->digit(i);
+    }
+    for (size_t i = 0; i < decimalSize; i++)
+    {
+        result.decimal[i] = this->digit(primarySize + i);
+    }
+    return result;
+}
+
+NumberView::operator std::string() const
+{
+    size_t primarySize = this->primarySize();
+    size_t decimalSize = this->decimalSize();
+    std::string result;
+    result.reserve(primarySize + decimalSize + 2);
+    if (this->isNegative())
+    {
+        result += '-';
+    }
+    for (size_t i = 0; i < primarySize + decimalSize; i++)
+    {
+        if (i == primarySize)
+        {
+            result += '.';
+        }
+        result += (char)('0' + this->digit(i));
+    }
+    return result;
+}
+
+NumberWriter::NumberWriter()
+{
+    this->position = 0;
+}
+
+NumberWriter::NumberWriter(const std::string& path) : NumberWriter()
+{
+    this->open(path);
+}
+
+NumberWriter::~NumberWriter()
+{
+    if (this->file.is_open())
+    {
+        this->close();
+    }
+}
+
+bool NumberWriter::open(const std::string& path)
+{
+    if (this->file.is_open())
+    {
+        this->file.close();
+    }
+    this->offsets.clear();
+    this->file.open(path, std::ios::binary | std::ios::out | std::ios::trunc);
+    if (this->file.is_open() == false)
+    {
+        return false;
+    }
+    // The header is rewritten by close()
+    char header[NUMBER_FILE_HEADER_SIZE] = {};
+    this->file.write(header, NUMBER_FILE_HEADER_SIZE);
+    this->position = NUMBER_FILE_HEADER_SIZE;
+    return this->file.good();
+}
+
+bool NumberWriter::isOpen() const
+{
+    return this->file.is_open();
+}
+
+bool NumberWriter::write(const Number& n)
+{
+    if (this->file.is_open() == false)
+    {
+        return false;
+    }
+    // Store the canonical form the reader validates, without leading zeros or ending decimal zeros and with a positive zero
+    size_t first = 0;
+    while (first + 1 < n.primary.size() && n.primary[first] == 0)
+    {
+        first++;
+    }
+    size_t decimalSize = n.decimal.size();
+    while (decimalSize > 0 && n.decimal[decimalSize - 1] == 0)
+    {
+        decimalSize--;
+    }
+    // A moved-from number has no integer digits, it is stored as 0
+    bool isEmpty = n.primary.size() == 0;
+    size_t primarySize = isEmpty ? 1 : n.primary.size() - first;
+    size_t totalDigits = primarySize + decimalSize;
+    bool isZero = (primarySize == 1 && (isEmpty || n.primary[first] == 0) && decimalSize == 0);
+    this->buffer.assign(NumberRecord::size(totalDigits), '\0');
+    unsigned char* p = (unsigned char*)&this->buffer[0];
+    NumberRecord::writeHeader(p, n.isNegative && isZero == false, n.decimalLength, primarySize, decimalSize);
+    unsigned char* digits = p + NUMBER_RECORD_HEADER_SIZE;
+    for (size_t i = 0; i < totalDigits; i++)
+    {
+        int d = i < primarySize ? (isEmpty ? 0 : n.primary[first + i]) : n.decimal[i - primarySize];
+        digits[i / 2] |= (unsigned char)((i % 2 == 0) ? (d << 4) : d);
+    }
+    this->file.write(this->buffer.data(), this->buffer.size());
+    this->offsets.push_back(this->position);
+    this->position += this->buffer.size();
+    return this->file.good();
+}
+
+bool NumberWriter::write(const std::vector<Number>& numbers)
+{
+    this->offsets.reserve(this->offsets.size() + numbers.size());
+    for (const Number& n : numbers)
+    {
+        if (this->write(n) == false)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool NumberWriter::close()
+{
+    if (this->file.is_open() == false)
+    {
+        return false;
+    }
+    // Write the index
+    uint64_t indexOffset = this->position;
+    std::vector<unsigned char> index(this->offsets.size() * 8);
+    for (size_t i = 0; i < this->offsets.size(); i++)
+    {
+        storeUint64(index.data() + i * 8, this->offsets[i]);
+    }
+    this->file.write((const char*)index.data(), index.size());
+    // Rewrite the header
+    unsigned char header[NUMBER_FILE_HEADER_SIZE] = {};
+    memcpy(header, NUMBER_FILE_MAGIC, 8);
+    storeUint32(header + 8, NUMBER_FILE_VERSION);
+    storeUint64(header + 16, this->offsets.size());
+    storeUint64(header + 24, indexOffset);
+    this->file.seekp(0);
+    this->file.write((const char*)header, NUMBER_FILE_HEADER_SIZE);
+    bool result = this->file.good();
+    this->file.close();
+    this->offsets.clear();
+    return result;
+}
+
+NumberReader::NumberReader()
+{
+    this->count = 0;
+    this->index = nullptr;
+}
+
+NumberReader::NumberReader(const std::string& path, bool validate) : NumberReader()
+{
+    this->open(path, validate);
+}
+
+bool NumberReader::open(const std::string& path, bool validate)
+{
+    this->close();
+    if (this->file.open(path) == false)
+    {
+        return false;
+    }
+    const unsigned char* data = this->file.data();
+    size_t size = this->file.size();
+    if (size < NUMBER_FILE_HEADER_SIZE || memcmp(data, NUMBER_FILE_MAGIC, 8) != 0 || loadUint32(data + 8) != NUMBER_FILE_VERSION)
+    {
+        this->close();
+        return false;
+    }
+    uint64_t count = loadUint64(data + 16);
+    uint64_t indexOffset = loadUint64(data + 24);
+    if (indexOffset < NUMBER_FILE_HEADER_SIZE || indexOffset > size || count > (size - indexOffset) / 8)
+    {
+        this->close();
+        return false;
+    }
+    if (validate)
+    {
+        for (uint64_t i = 0; i < count; i++)
+        {
+            uint64_t offset = loadUint64(data + indexOffset + i * 8);
+            if (offset % 8 != 0 || offset < NUMBER_FILE_HEADER_SIZE || offset > indexOffset - NUMBER_RECORD_HEADER_SIZE)
+            {
+                this->close();
+                return false;
+            }
+            uint64_t totalDigits = (uint64_t)loadUint32(data + offset + 8) + loadUint32(data + offset + 12);
+            if (loadUint32(data + offset + 8) == 0 || NumberRecord::size(totalDigits) > indexOffset - offset || NumberRecord::isCanonical(data + offset) == false)
+            {
+                this->close();
+                return false;
+            }
+        }
+    }
+    this->count = (size_t)count;
+    this->index = data + indexOffset;
+    return true;
+}
+
+void NumberReader::close()
+{
+    this->file.close();
+    this->count = 0;
+    this->index = nullptr;
+}
+
+bool NumberReader::isOpen() const
+{
+    return this->index != nullptr;
+}
+
+size_t NumberReader::size() const
+{
+    return this->count;
+}
+
+NumberView NumberReader::operator [] (size_t i) const
+{
+    return NumberView(this->file.data() + loadUint64(this->index + i * 8));
+}
+
+std::vector<Number> NumberReader::read(size_t first, size_t count) const
+{
+    std::vector<Number> result;
+    if (first >= this->count)
+    {
+        return result;
+    }
+    if (count > this->count - first)
+    {
+        count = this->count - first;
+    }
+    result.reserve(count);
+    for (size_t i = first; i < first + count; i++)
+    {
+        result.push_back((*this)[i].toNumber());
+    }
+    return result;
+}
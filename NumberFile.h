@@ -0,0 +1,114 @@
+#pragma once
+
+#include <fstream>
+#include <cstdint>
+#include "Number.h"
+#include "MappedFile.h"
+
+#define NUMBER_FILE_VERSION 1
+
+// Binary format for arrays of Number, all integers are little-endian
+// Header (32 bytes): "CPPUNUM\0" | uint32 version | uint32 reserved | uint64 count | uint64 index offset
+// Record (8 bytes aligned): uint8 sign | 3 bytes reserved | uint32 decimalLength | uint32 integer digits | uint32 decimal digits | packed digits
+// Packed digits: two digits per byte, the first digit in the high nibble, integer digits first, then decimal digits
+// Index: one uint64 record offset for each value, the index is written after all records
+
+// Bytes of a record before the packed digits
+#define NUMBER_RECORD_HEADER_SIZE 16
+
+// Record layout shared by NumberWriter and NumberLoader, so the format is defined in one place
+class NumberRecord
+{
+public:
+    // Size of a record with totalDigits digits, including the header and the padding
+    static size_t size(size_t totalDigits);
+    // Write the header of a record, the sign byte is 1 if isNegative is true
+    static void writeHeader(unsigned char* record, bool isNegative, size_t decimalLength, size_t primarySize, size_t decimalSize);
+    // Check the digits of a complete record: every digit in [0, 9], no leading integer zeros, no ending decimal zeros and no negative zero
+    static bool isCanonical(const unsigned char* record);
+};
+
+// Zero-copy view of a record inside a mapped file, the view is invalid once the file is closed
+class NumberView
+{
+private:
+    const unsigned char* record;
+
+public:
+    NumberView(const unsigned char* record);
+
+    bool isNegative() const;
+    // Number of digits before the decimal point, at least 1
+    size_t primarySize() const;
+    // Number of digits after the decimal point
+    size_t decimalSize() const;
+    // The decimalLength setting of the stored Number
+    size_t getDecimalLength() const;
+    // Digit at position i, counting from the highest integer digit, decimal digits follow the integer digits
+    int digit(size_t i) const;
+    // Compare the values without decoding, return -1 if *this < n, 0 if equal, 1 if *this > n
+    int compare(const NumberView& n) const;
+
+    bool operator == (const NumberView& n) const;
+    bool operator != (const NumberView& n) const;
+    bool operator < (const NumberView& n) const;
+    bool operator > (const NumberView& n) const;
+    bool operator <= (const NumberView& n) const;
+    bool operator >= (const NumberView& n) const;
+
+    // Decode into a Number
+    Number toNumber() const;
+    operator std::string() const;
+};
+
+// Append Number values to a binary file, the file is only valid after close() is called
+class NumberWriter
+{
+private:
+    std::ofstream file;
+    std::vector<uint64_t> offsets;
+    uint64_t position;
+    std::string buffer;
+
+public:
+    NumberWriter();
+    // Create the file at path, see open()
+    NumberWriter(const std::string& path);
+    // Close the file if it is still open
+    ~NumberWriter();
+
+    // Create or truncate the file, return false if the file cannot be created
+    bool open(const std::string& path);
+    bool isOpen() const;
+    // Append a single value, return false if the file is not open or writing failed
+    bool write(const Number& n);
+    // Append all values in the vector, return false if the file is not open or writing failed
+    bool write(const std::vector<Number>& numbers);
+    // Write the index and the header, return false if writing failed
+    bool close();
+};
+
+// Read a binary Number file through a memory mapping, values are accessed as NumberView without parsing
+class NumberReader
+{
+private:
+    MappedFile file;
+    size_t count;
+    const unsigned char* index;
+
+public:
+    NumberReader();
+    // Open the file at path, see open()
+    NumberReader(const std::string& path, bool validate = true);
+
+    // Map the file and check the header, set validate to true to check the bounds and the digits of every record as well, return false if the file is invalid
+    bool open(const std::string& path, bool validate = true);
+    void close();
+    bool isOpen() const;
+    // Number of values in the file
+    size_t size() const;
+    // View of the value at position i, i must be less than size()
+    NumberView operator [] (size_t i) const;
+    // Decode values [first, first + count), the range is clipped to the end of the file
+    std::vector<Number> read(size_t first, size_t count) const;
+};
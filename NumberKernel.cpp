@@ -0,0 +1,1019 @@
+#include "NumberKernel.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+// Two NTT friendly primes, both have 3 as a primitive root, CRT of them covers 4.6e17
+static const uint32_t NTT_PRIME_1 = 998244353;
+static const uint32_t NTT_PRIME_2 = 469762049;
+static const uint32_t NTT_ROOT = 3;
+
+static uint64_t powerMod(uint64_t a, uint64_t e, uint64_t mod)
+{
+    uint64_t result = 1;
+    a %= mod;
+    while (e > 0)
+    {
+        if (e & 1)
+        {
+            result = result * a % mod;
+        }
+        a = a * a % mod;
+        e >>= 1;
+    }
+    return result;
+}
+
+std::unique_ptr<ThreadPool> NumberKernel::pool;
+size_t NumberKernel::karatsubaThreshold = KARATSUBA_THRESHOLD;
+size_t NumberKernel::nttThreshold = NTT_THRESHOLD;
+size_t NumberKernel::parallelThreshold = PARALLEL_THRESHOLD;
+size_t NumberKernel::radixThreshold = RADIX_THRESHOLD;
+// Power tables of radix conversions, indexed by (from, to)
+static std::mutex radixMutex;
+static std::map<std::pair<uint64_t, uint64_t>, std::vector<std::shared_ptr<const NumberKernel::Limbs>>> radixTables;
+
+// Load the machine specific thresholds before main() if the environment names a file
+static bool loadThresholdsAtStartup()
+{
+    const char* path = std::getenv(THRESHOLDS_ENVIRONMENT);
+    return path != nullptr && NumberKernel::loadThresholds(path);
+}
+static bool isThresholdsLoaded = loadThresholdsAtStartup();
+
+void NumberKernel::setParallel(unsigned int threads, size_t threshold, bool isPinned)
+{
+    pool.reset();
+    if (threshold != 0)
+    {
+        parallelThreshold = threshold;
+    }
+    if (threads != 1)
+    {
+        pool.reset(new ThreadPool(threads, isPinned));
+    }
+}
+
+size_t NumberKernel::getParallelThreads()
+{
+    return pool ? pool->size() : 0;
+}
+
+ThreadPool* NumberKernel::getPool()
+{
+    return pool.get();
+}
+
+void NumberKernel::setThresholds(size_t karatsuba, size_t ntt, size_t parallel)
+{
+    // Karatsuba splits operands in half, it needs at least 2 limbs
+    karatsubaThreshold = std::max(karatsuba, (size_t)2);
+    nttThreshold = ntt;
+    parallelThreshold = parallel;
+}
+
+void NumberKernel::setRadixThreshold(size_t radix)
+{
+    radixThreshold = radix;
+}
+
+size_t NumberKernel::getKaratsubaThreshold()
+{
+    return karatsubaThreshold;
+}
+
+size_t NumberKernel::getNttThreshold()
+{
+    return nttThreshold;
+}
+
+size_t NumberKernel::getParallelThreshold()
+{
+    return parallelThreshold;
+}
+
+size_t NumberKernel::getRadixThreshold()
+{
+    return radixThreshold;
+}
+
+bool NumberKernel::loadThresholds(const std::string& path)
+{
+    std::ifstream file(path);
+    if (file.is_open() == false)
+    {
+        return false;
+    }
+    size_t karatsuba = karatsubaThreshold;
+    size_t ntt = nttThreshold;
+    size_t parallel = parallelThreshold;
+    size_t radix = radixThreshold;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        line = line.substr(0, line.find('#'));
+        std::istringstream stream(line);
+        std::string name;
+        if (!(stream >> name))
+        {
+            continue;
+        }
+        unsigned long long value;
+        if (!(stream >> value))
+        {
+            return false;
+        }
+        if (name == "KARATSUBA_THRESHOLD")
+        {
+            karatsuba = (size_t)value;
+        }
+        else if (name == "NTT_THRESHOLD")
+        {
+            ntt = (size_t)value;
+        }
+        else if (name == "PARALLEL_THRESHOLD")
+        {
+            parallel = (size_t)value;
+        }
+        else if (name == "RADIX_THRESHOLD")
+        {
+            radix = (size_t)value;
+        }
+    }
+    setThresholds(karatsuba, ntt, parallel);
+    setRadixThreshold(radix);
+    return true;
+}
+
+bool NumberKernel::saveThresholds(const std::string& path)
+{
+    std::ofstream file(path);
+    file << "# Number kernel thresholds in limbs\n";
+    file << "KARATSUBA_THRESHOLD " << karatsubaThreshold << "\n";
+    file << "NTT_THRESHOLD " << nttThreshold << "\n";
+    file << "PARALLEL_THRESHOLD " << parallelThreshold << "\n";
+    file << "RADIX_THRESHOLD " << radixThreshold << "\n";
+    return file.good();
+}
+
+ThreadPool* NumberKernel::poolFor(size_t limbs)
+{
+    return limbs >= parallelThreshold ? pool.get() : nullptr;
+}
+
+void NumberKernel::trim(Limbs& a)
+{
+    while (a.size() > 0 && a.back() == 0)
+    {
+        a.pop_back();
+    }
+}
+
+int NumberKernel::compare(const Limbs& a, const Limbs& b)
+{
+    if (a.size() != b.size())
+    {
+        return a.size() < b.size() ? -1 : 1;
+    }
+    for (size_t i = a.size(); i > 0; i--)
+    {
+        if (a[i - 1] != b[i - 1])
+        {
+            return a[i - 1] < b[i - 1] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+NumberKernel::Limbs NumberKernel::add(const Limbs& a, const Limbs& b, uint64_t base)
+{
+    Limbs result = a.size() >= b.size() ? a : b;
+    const Limbs& shorter = a.size() >= b.size() ? b : a;
+    addShifted(result, shorter, 0, base);
+    return result;
+}
+
+NumberKernel::Limbs NumberKernel::subtract(const Limbs& a, const Limbs& b, uint64_t base)
+{
+    Limbs result = a;
+    subtractInPlace(result, b, base);
+    return result;
+}
+
+void NumberKernel::addShifted(Limbs& r, const Limbs& x, size_t shift, uint64_t base)
+{
+    if (x.size() == 0)
+    {
+        return;
+    }
+    if (r.size() < x.size() + shift)
+    {
+        r.resize(x.size() + shift, 0);
+    }
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < x.size(); i++)
+    {
+        uint64_t t = (uint64_t)r[i + shift] + x[i] + carry;
+        carry = t >= base ? 1 : 0;
+        r[i + shift] = (uint32_t)(t - carry * base);
+    }
+    for (i += shift; carry > 0 && i < r.size(); i++)
+    {
+        uint64_t t = (uint64_t)r[i] + carry;
+        carry = t >= base ? 1 : 0;
+        r[i] = (uint32_t)(t - carry * base);
+    }
+    if (carry > 0)
+    {
+        r.push_back((uint32_t)carry);
+    }
+}
+
+void NumberKernel::subtractInPlace(Limbs& r, const Limbs& x, uint64_t base)
+{
+    uint64_t borrow = 0;
+    size_t i = 0;
+    for (; i < x.size(); i++)
+    {
+        uint64_t sub = (uint64_t)x[i] + borrow;
+        if (r[i] >= sub)
+        {
+            r[i] = (uint32_t)(r[i] - sub);
+            borrow = 0;
+        }
+        else
+        {
+            r[i] = (uint32_t)(r[i] + base - sub);
+            borrow = 1;
+        }
+    }
+    for (; borrow > 0 && i < r.size(); i++)
+    {
+        if (r[i] > 0)
+        {
+            r[i]--;
+            borrow = 0;
+        }
+        else
+        {
+            r[i] = (uint32_t)(base - 1);
+        }
+    }
+    trim(r);
+}
+
+NumberKernel::Limbs NumberKernel::multiplySmall(const Limbs& a, uint64_t m, uint64_t base)
+{
+    Limbs result;
+    if (a.size() == 0 || m == 0)
+    {
+        return result;
+    }
+    result.reserve(a.size() + 2);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        uint64_t t = a[i] * m + carry;
+        result.push_back((uint32_t)(t % base));
+        carry = t / base;
+    }
+    while (carry > 0)
+    {
+        result.push_back((uint32_t)(carry % base));
+        carry /= base;
+    }
+    return result;
+}
+
+NumberKernel::Limbs NumberKernel::multiply(const Limbs& a, const Limbs& b, uint64_t base)
+{
+    if (a.size() == 0 || b.size() == 0)
+    {
+        return Limbs();
+    }
+    const Limbs& longer = a.size() >= b.size() ? a : b;
+    const Limbs& shorter = a.size() >= b.size() ? b : a;
+    if (shorter.size() < karatsubaThreshold)
+    {
+        return multiplySchoolbook(longer, shorter, base);
+    }
+    if (longer.size() > 2 * shorter.size())
+    {
+        // Unbalanced operands, cut the longer one into slices as long as the shorter one
+        size_t count = (longer.size() + shorter.size() - 1) / shorter.size();
+        std::vector<Limbs> products(count);
+        auto multiplySlices = [&](size_t first, size_t last)
+        {
+            for (size_t s = first; s < last; s++)
+            {
+                size_t end = std::min(longer.size(), (s + 1) * shorter.size());
+                Limbs slice(longer.begin() + s * shorter.size(), longer.begin() + end);
+                trim(slice);
+                products[s] = multiply(slice, shorter, base);
+            }
+        };
+        ThreadPool* threads = poolFor(shorter.size());
+        if (threads != nullptr)
+        {
+            threads->parallelFor(0, count, 1, multiplySlices);
+        }
+        else
+        {
+            multiplySlices(0, count);
+        }
+        Limbs result;
+        for (size_t s = 0; s < count; s++)
+        {
+            addShifted(result, products[s], s * shorter.size(), base);
+        }
+        trim(result);
+        return result;
+    }
+    if (base <= 65536 && shorter.size() >= nttThreshold && a.size() + b.size() <= NTT_MAX_LENGTH)
+    {
+        return multiplyNTT(a, b, base);
+    }
+    return multiplyKaratsuba(longer, shorter, base);
+}
+
+NumberKernel::Limbs NumberKernel::product(std::vector<Limbs>& items, uint64_t base)
+{
+    if (items.size() == 0)
+    {
+        return Limbs(1, 1);
+    }
+    return productRange(items, 0, items.size(), base);
+}
+
+NumberKernel::Limbs NumberKernel::divideSmall(const Limbs& a, uint64_t d, uint64_t base, uint64_t* remainder)
+{
+    Limbs quotient(a.size(), 0);
+    uint64_t r = 0;
+    for (size_t i = a.size(); i > 0; i--)
+    {
+        uint64_t t = r * base + a[i - 1];
+        quotient[i - 1] = (uint32_t)(t / d);
+        r = t % d;
+    }
+    trim(quotient);
+    if (remainder != nullptr)
+    {
+        *remainder = r;
+    }
+    return quotient;
+}
+
+void NumberKernel::divide(const Limbs& a, const Limbs& b, uint64_t base, Limbs* quotient, Limbs* remainder)
+{
+    if (compare(a, b) < 0)
+    {
+        if (quotient != nullptr)
+        {
+            quotient->clear();
+        }
+        if (remainder != nullptr)
+        {
+            *remainder = a;
+        }
+        return;
+    }
+    if (b.size() == 1)
+    {
+        uint64_t r = 0;
+        Limbs q = divideSmall(a, b[0], base, &r);
+        if (quotient != nullptr)
+        {
+            *quotient = q;
+        }
+        if (remainder != nullptr)
+        {
+            *remainder = fromWord(r, base);
+        }
+        return;
+    }
+
+    // Normalize so that the highest limb of the divisor is at least base / 2
+    uint64_t d = base / ((uint64_t)b.back() + 1);
+    Limbs u = multiplySmall(a, d, base);
+    Limbs v = multiplySmall(b, d, base);
+    u.resize(a.size() + 1, 0);
+    size_t n = v.size();
+    size_t m = a.size() - n;
+    uint64_t vTop = v[n - 1];
+    uint64_t vNext = v[n - 2];
+    Limbs q(m + 1, 0);
+
+    for (size_t j = m + 1; j > 0; j--)
+    {
+        size_t k = j - 1;
+        // Estimate the quotient digit from the top two limbs, it is at most 2 larger than the real one
+        uint64_t numerator = u[k + n] * base + u[k + n - 1];
+        uint64_t qhat = numerator / vTop;
+        uint64_t rhat = numerator % vTop;
+        while (qhat >= base || qhat * vNext > rhat * base + u[k + n - 2])
+        {
+            qhat--;
+            rhat += vTop;
+            if (rhat >= base)
+            {
+                break;
+            }
+        }
+
+        // Multiply and subtract
+        uint64_t carry = 0;
+        uint64_t borrow = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            uint64_t p = qhat * v[i] + carry;
+            carry = p / base;
+            uint64_t sub = p % base + borrow;
+            if (u[i + k] >= sub)
+            {
+                u[i + k] = (uint32_t)(u[i + k] - sub);
+                borrow = 0;
+            }
+            else
+            {
+                u[i + k] = (uint32_t)(u[i + k] + base - sub);
+                borrow = 1;
+            }
+        }
+        uint64_t sub = carry + borrow;
+        if (u[k + n] >= sub)
+        {
+            u[k + n] = (uint32_t)(u[k + n] - sub);
+        }
+        else
+        {
+            // The estimation was 1 too large, add the divisor back
+            qhat--;
+            carry = 0;
+            for (size_t i = 0; i < n; i++)
+            {
+                uint64_t t = (uint64_t)u[i + k] + v[i] + carry;
+                carry = t >= base ? 1 : 0;
+                u[i + k] = (uint32_t)(t - carry * base);
+            }
+            u[k + n] = 0;
+        }
+        q[k] = (uint32_t)qhat;
+    }
+
+    if (quotient != nullptr)
+    {
+        trim(q);
+        *quotient = q;
+    }
+    if (remainder != nullptr)
+    {
+        u.resize(n);
+        trim(u);
+        *remainder = divideSmall(u, d, base, nullptr);
+    }
+}
+
+NumberKernel::Limbs NumberKernel::gcd(Limbs a, Limbs b, uint64_t base)
+{
+    trim(a);
+    trim(b);
+    if (compare(a, b) < 0)
+    {
+        std::swap(a, b);
+    }
+    while (b.size() > 0)
+    {
+        uint64_t x = 0;
+        uint64_t y = 0;
+        if (toWord(a, base, &x))
+        {
+            toWord(b, base, &y);
+            return fromWord(binaryGcd(x, y), base);
+        }
+
+        // Take the leading limbs of a, and the limbs of b at the same position, as single word approximations
+        size_t h = 1;
+        uint64_t xHat = a.back();
+        while (h < a.size() && xHat <= (UINT32_MAX - a[a.size() - 1 - h]) / base)
+        {
+            xHat = xHat * base + a[a.size() - 1 - h];
+            h++;
+        }
+        uint64_t yHat = 0;
+        for (size_t i = a.size(); i > a.size() - h; i--)
+        {
+            yHat = yHat * base + (i - 1 < b.size() ? b[i - 1] : 0);
+        }
+
+        // Simulate Euclid's algorithm on the approximations as long as the quotients are guaranteed to be the same
+        int64_t ca = 1;
+        int64_t cb = 0;
+        int64_t cc = 0;
+        int64_t cd = 1;
+        int64_t xh = (int64_t)xHat;
+        int64_t yh = (int64_t)yHat;
+        while (yh + cc != 0 && yh + cd != 0)
+        {
+            int64_t q = (xh + ca) / (yh + cc);
+            if (q != (xh + cb) / (yh + cd))
+            {
+                break;
+            }
+            int64_t t = ca - q * cc;
+            ca = cc;
+            cc = t;
+            t = cb - q * cd;
+            cb = cd;
+            cd = t;
+            t = xh - q * yh;
+            xh = yh;
+            yh = t;
+        }
+
+        if (cb == 0)
+        {
+            // No progress on the approximations, do a full division step
+            Limbs r;
+            divide(a, b, base, nullptr, &r);
+            a = std::move(b);
+            b = std::move(r);
+        }
+        else
+        {
+            // The cofactors always have alternating signs
+            Limbs na = combine(a, (uint64_t)(ca < 0 ? -ca : ca), b, (uint64_t)(cb < 0 ? -cb : cb), base);
+            Limbs nb = combine(a, (uint64_t)(cc < 0 ? -cc : cc), b, (uint64_t)(cd < 0 ? -cd : cd), base);
+            a = std::move(na);
+            b = std::move(nb);
+        }
+    }
+    return a;
+}
+
+bool NumberKernel::toWord(const Limbs& a, uint64_t base, uint64_t* word)
+{
+    uint64_t result = 0;
+    for (size_t i = a.size(); i > 0; i--)
+    {
+        if (result > (UINT64_MAX - a[i - 1]) / base)
+        {
+            return false;
+        }
+        result = result * base + a[i - 1];
+    }
+    *word = result;
+    return true;
+}
+
+NumberKernel::Limbs NumberKernel::fromWord(uint64_t word, uint64_t base)
+{
+    Limbs result;
+    while (word > 0)
+    {
+        result.push_back((uint32_t)(word % base));
+        word /= base;
+    }
+    return result;
+}
+
+NumberKernel::Limbs NumberKernel::convert(const Limbs& a, uint64_t from, uint64_t to)
+{
+    if (from == to || a.size() == 0)
+    {
+        Limbs result = a;
+        trim(result);
+        return result;
+    }
+    // Both bases are powers of two, only the bits are regrouped
+    if ((from & (from - 1)) == 0 && (to & (to - 1)) == 0)
+    {
+        int fromBits = 0;
+        int toBits = 0;
+        while (((uint64_t)1 << fromBits) < from)
+        {
+            fromBits++;
+        }
+        while (((uint64_t)1 << toBits) < to)
+        {
+            toBits++;
+        }
+        Limbs result;
+        result.reserve((a.size() * fromBits + toBits - 1) / toBits);
+        uint64_t buffer = 0;
+        int bits = 0;
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            buffer |= (uint64_t)a[i] << bits;
+            bits += fromBits;
+            while (bits >= toBits)
+            {
+                result.push_back((uint32_t)(buffer & (to - 1)));
+                buffer >>= toBits;
+                bits -= toBits;
+            }
+        }
+        if (bits > 0)
+        {
+            result.push_back((uint32_t)buffer);
+        }
+        trim(result);
+        return result;
+    }
+    size_t count = 0;
+    while (((size_t)1 << count) < a.size())
+    {
+        count++;
+    }
+    return convertRange(a, 0, a.size(), from, to, radixPowers(from, to, count));
+}
+
+std::vector<std::shared_ptr<const NumberKernel::Limbs>> NumberKernel::radixPowers(uint64_t from, uint64_t to, size_t count)
+{
+    std::lock_guard<std::mutex> lock(radixMutex);
+    std::vector<std::shared_ptr<const Limbs>>& table = radixTables[std::make_pair(from, to)];
+    if (table.size() == 0 && count > 0)
+    {
+        table.push_back(std::make_shared<const Limbs>(fromWord(from, to)));
+    }
+    while (table.size() < count)
+    {
+        const Limbs& last = *table.back();
+        table.push_back(std::make_shared<const Limbs>(multiply(last, last, to)));
+    }
+    // Copy the pointers, so later extensions by other threads do not move the table under the caller
+    return std::vector<std::shared_ptr<const Limbs>>(table.begin(), table.begin() + std::min(count, table.size()));
+}
+
+NumberKernel::Limbs NumberKernel::convertRange(const Limbs& a, size_t first, size_t last, uint64_t from, uint64_t to, const std::vector<std::shared_ptr<const Limbs>>& powers)
+{
+    size_t n = last - first;
+    if (n <= radixThreshold || n < 2)
+    {
+        // Horner's rule, the carry never exceeds from, so every step fits in 64 bits
+        Limbs result;
+        for (size_t i = last; i-- > first;)
+        {
+            uint64_t carry = a[i];
+            for (size_t j = 0; j < result.size(); j++)
+            {
+                uint64_t t = result[j] * from + carry;
+                result[j] = (uint32_t)(t % to);
+                carry = t / to;
+            }
+            while (carry > 0)
+            {
+                result.push_back((uint32_t)(carry % to));
+                carry /= to;
+            }
+        }
+        return result;
+    }
+    // The low half has 2^k limbs, so the high half is scaled by from^(2^k)
+    size_t k = 0;
+    while (((size_t)2 << k) < n)
+    {
+        k++;
+    }
+    size_t middle = first + ((size_t)1 << k);
+    Limbs low;
+    Limbs high;
+    ThreadPool* threads = poolFor(n);
+    if (threads != nullptr)
+    {
+        threads->run({
+            [&]() { low = convertRange(a, first, middle, from, to, powers); },
+            [&]() { high = convertRange(a, middle, last, from, to, powers); }
+        });
+    }
+    else
+    {
+        low = convertRange(a, first, middle, from, to, powers);
+        high = convertRange(a, middle, last, from, to, powers);
+    }
+    Limbs result = multiply(high, *powers[k], to);
+    addShifted(result, low, 0, to);
+    trim(result);
+    return result;
+}
+
+NumberKernel::Limbs NumberKernel::multiplySchoolbook(const Limbs& a, const Limbs& b, uint64_t base)
+{
+    Limbs result(a.size() + b.size(), 0);
+    if (base <= 65536)
+    {
+        // Every product is less than 2^32, so the accumulators cannot overflow before the final carry pass
+        std::vector<uint64_t> acc(a.size() + b.size(), 0);
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            uint64_t ai = a[i];
+            if (ai == 0)
+            {
+                continue;
+            }
+            uint64_t* row = acc.data() + i;
+            for (size_t j = 0; j < b.size(); j++)
+            {
+                row[j] += ai * b[j];
+            }
+        }
+        uint64_t carry = 0;
+        for (size_t i = 0; i < acc.size(); i++)
+        {
+            uint64_t t = acc[i] + carry;
+            result[i] = (uint32_t)(t % base);
+            carry = t / base;
+        }
+    }
+    else
+    {
+        // (base - 1)^2 + 2 * (base - 1) still fits in 64 bits when the base is 2^32
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            uint64_t ai = a[i];
+            uint64_t carry = 0;
+            for (size_t j = 0; j < b.size(); j++)
+            {
+                uint64_t t = result[i + j] + ai * b[j] + carry;
+                result[i + j] = (uint32_t)(t % base);
+                carry = t / base;
+            }
+            result[i + b.size()] = (uint32_t)carry;
+        }
+    }
+    trim(result);
+    return result;
+}
+
+NumberKernel::Limbs NumberKernel::multiplyKaratsuba(const Limbs& a, const Limbs& b, uint64_t base)
+{
+    // a = a1 * base^m + a0, b = b1 * base^m + b0
+    // a * b = z2 * base^2m + (z1 - z2 - z0) * base^m + z0
+    size_t m = std::max(a.size(), b.size()) / 2;
+    Limbs a0(a.begin(), a.begin() + std::min(m, a.size()));
+    Limbs a1(a.begin() + std::min(m, a.size()), a.end());
+    Limbs b0(b.begin(), b.begin() + std::min(m, b.size()));
+    Limbs b1(b.begin() + std::min(m, b.size()), b.end());
+    trim(a0);
+    trim(b0);
+
+    Limbs z0;
+    Limbs z1;
+    Limbs z2;
+    ThreadPool* threads = poolFor(b.size());
+    if (threads != nullptr)
+    {
+        // The three sub-products are independent
+        threads->run({
+            [&]() { z0 = multiply(a0, b0, base); },
+            [&]() { z2 = multiply(a1, b1, base); },
+            [&]() { z1 = multiply(add(a0, a1, base), add(b0, b1, base), base); }
+        });
+    }
+    else
+    {
+        z0 = multiply(a0, b0, base);
+        z2 = multiply(a1, b1, base);
+        z1 = multiply(add(a0, a1, base), add(b0, b1, base), base);
+    }
+    subtractInPlace(z1, z0, base);
+    subtractInPlace(z1, z2, base);
+
+    Limbs result = z0;
+    addShifted(result, z1, m, base);
+    addShifted(result, z2, 2 * m, base);
+    trim(result);
+    return result;
+}
+
+NumberKernel::Limbs NumberKernel::multiplyNTT(const Limbs& a, const Limbs& b, uint64_t base)
+{
+    size_t length = 1;
+    while (length < a.size() + b.size())
+    {
+        length <<= 1;
+    }
+
+    std::vector<uint32_t> fa1(a.begin(), a.end());
+    std::vector<uint32_t> fb1(b.begin(), b.end());
+    fa1.resize(length, 0);
+    fb1.resize(length, 0);
+    std::vector<uint32_t> fa2 = fa1;
+    std::vector<uint32_t> fb2 = fb1;
+
+    // Cyclic convolution modulo one prime
+    auto convolve = [length](std::vector<uint32_t>& fa, std::vector<uint32_t>& fb, uint32_t mod)
+    {
+        ntt(fa, false, mod, NTT_ROOT);
+        ntt(fb, false, mod, NTT_ROOT);
+        for (size_t i = 0; i < length; i++)
+        {
+            fa[i] = (uint32_t)((uint64_t)fa[i] * fb[i] % mod);
+        }
+        ntt(fa, true, mod, NTT_ROOT);
+    };
+    ThreadPool* threads = poolFor(length);
+    if (threads != nullptr)
+    {
+        threads->run({
+            [&]() { convolve(fa1, fb1, NTT_PRIME_1); },
+            [&]() { convolve(fa2, fb2, NTT_PRIME_2); }
+        });
+    }
+    else
+    {
+        convolve(fa1, fb1, NTT_PRIME_1);
+        convolve(fa2, fb2, NTT_PRIME_2);
+    }
+
+    // Chinese remainder theorem: x = r1 + p1 * ((r2 - r1) * p1^-1 mod p2)
+    uint64_t inverse = powerMod(NTT_PRIME_1, NTT_PRIME_2 - 2, NTT_PRIME_2);
+    Limbs result(a.size() + b.size(), 0);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < result.size(); i++)
+    {
+        uint64_t r1 = fa1[i];
+        uint64_t r2 = fa2[i];
+        uint64_t k = (r2 + NTT_PRIME_2 - r1 % NTT_PRIME_2) % NTT_PRIME_2 * inverse % NTT_PRIME_2;
+        uint64_t t = r1 + NTT_PRIME_1 * k + carry;
+        result[i] = (uint32_t)(t % base);
+        carry = t / base;
+    }
+    trim(result);
+    return result;
+}
+
+void NumberKernel::ntt(std::vector<uint32_t>& a, bool invert, uint32_t mod, uint32_t root)
+{
+    size_t n = a.size();
+    // Bit reversal permutation
+    for (size_t i = 1, j = 0; i < n; i++)
+    {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+        {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j)
+        {
+            std::swap(a[i], a[j]);
+        }
+    }
+
+    // Shoup's trick: with w' = floor(w * 2^32 / mod), a * w mod mod can be calculated without division
+    std::vector<uint32_t> twiddle;
+    std::vector<uint32_t> twiddleShoup;
+    ThreadPool* threads = poolFor(n);
+    for (size_t len = 2; len <= n; len <<= 1)
+    {
+        uint64_t w = powerMod(root, (mod - 1) / len, mod);
+        if (invert)
+        {
+            w = powerMod(w, mod - 2, mod);
+        }
+        size_t half = len / 2;
+        twiddle.resize(half);
+        twiddleShoup.resize(half);
+        twiddle[0] = 1;
+        for (size_t k = 1; k < half; k++)
+        {
+            twiddle[k] = (uint32_t)((uint64_t)twiddle[k - 1] * w % mod);
+        }
+        for (size_t k = 0; k < half; k++)
+        {
+            twiddleShoup[k] = (uint32_t)(((uint64_t)twiddle[k] << 32) / mod);
+        }
+        // Butterflies [first, last) of this level, butterfly t works on block t / half at offset t % half
+        auto butterflies = [&](size_t first, size_t last)
+        {
+            size_t t = first;
+            while (t < last)
+            {
+                size_t i = t / half * len;
+                size_t k = t % half;
+                size_t end = std::min(half, k + (last - t));
+                t += end - k;
+                for (; k < end; k++)
+                {
+                    uint32_t u = a[i + k];
+                    uint32_t x = a[i + k + half];
+                    uint32_t q = (uint32_t)(((uint64_t)x * twiddleShoup[k]) >> 32);
+                    uint32_t v = x * twiddle[k] - q * mod;
+                    v = v >= mod ? v - mod : v;
+                    a[i + k] = u + v >= mod ? u + v - mod : u + v;
+                    a[i + k + half] = u >= v ? u - v : u + mod - v;
+                }
+            }
+        };
+        if (threads != nullptr)
+        {
+            threads->parallelFor(0, n / 2, parallelThreshold, butterflies);
+        }
+        else
+        {
+            butterflies(0, n / 2);
+        }
+    }
+
+    if (invert)
+    {
+        uint64_t inverseN = powerMod(n, mod - 2, mod);
+        for (size_t i = 0; i < n; i++)
+        {
+            a[i] = (uint32_t)(a[i] * inverseN % mod);
+        }
+    }
+}
+
+NumberKernel::Limbs NumberKernel::productRange(std::vector<Limbs>& items, size_t first, size_t last, uint64_t base)
+{
+    if (last - first == 1)
+    {
+        return std::move(items[first]);
+    }
+    if (last - first == 2)
+    {
+        return multiply(items[first], items[first + 1], base);
+    }
+    size_t middle = first + (last - first) / 2;
+    Limbs left;
+    Limbs right;
+    ThreadPool* threads = nullptr;
+    if (pool)
+    {
+        size_t limbs = 0;
+        for (size_t i = first; i < last; i++)
+        {
+            limbs += items[i].size();
+        }
+        threads = poolFor(limbs);
+    }
+    if (threads != nullptr)
+    {
+        threads->run({
+            [&]() { left = productRange(items, first, middle, base); },
+            [&]() { right = productRange(items, middle, last, base); }
+        });
+    }
+    else
+    {
+        left = productRange(items, first, middle, base);
+        right = productRange(items, middle, last, base);
+    }
+    return multiply(left, right, base);
+}
+
+uint64_t NumberKernel::binaryGcd(uint64_t a, uint64_t b)
+{
+    if (a == 0)
+    {
+        return b;
+    }
+    if (b == 0)
+    {
+        return a;
+    }
+    int shift = 0;
+    while (((a | b) & 1) == 0)
+    {
+        a >>= 1;
+        b >>= 1;
+        shift++;
+    }
+    while ((a & 1) == 0)
+    {
+        a >>= 1;
+    }
+    while (b != 0)
+    {
+        while ((b & 1) == 0)
+        {
+            b >>= 1;
+        }
+        if (a > b)
+        {
+            std::swap(a, b);
+        }
+        b -= a;
+    }
+    return a << shift;
+}
+
+NumberKernel::Limbs NumberKernel::combine(const Limbs& a, uint64_t ca, const Limbs& b, uint64_t cb, uint64_t base)
+{
+    Limbs x = multiplySmall(a, ca, base);
+    Limbs y = multiplySmall(b, cb, base);
+    if (compare(x, y) < 0)
+    {
+        std::swap(x, y);
+    }
+    subtractInPlace(x, y, base);
+    return x;
+}
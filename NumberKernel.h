@@ -0,0 +1,123 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+class ThreadPool;
+
+// Default thresholds, they can be overridden with -D, a header generated by tools/tuneup, or at runtime with loadThresholds()
+// Operands shorter than this (in limbs) are multiplied with the schoolbook algorithm
+#ifndef KARATSUBA_THRESHOLD
+#define KARATSUBA_THRESHOLD 32
+#endif
+// Operands longer than this (in limbs) are multiplied with NTT when the base allows it
+#ifndef NTT_THRESHOLD
+#define NTT_THRESHOLD 1536
+#endif
+// NTT can only transform up to 2^23 limbs, longer products are split by Karatsuba first
+#define NTT_MAX_LENGTH 8388608
+// With a thread pool enabled, operands of at least this many limbs are split across the threads
+#ifndef PARALLEL_THRESHOLD
+#define PARALLEL_THRESHOLD 4096
+#endif
+// Radix conversions of at most this many limbs use Horner's rule, longer ones are split in halves
+#ifndef RADIX_THRESHOLD
+#define RADIX_THRESHOLD 16
+#endif
+// Environment variable naming a threshold file which is loaded at startup
+#define THRESHOLDS_ENVIRONMENT "NUMBER_THRESHOLDS"
+
+// Low level algorithms working on little-endian limb vectors, the lowest limb is stored first
+// Every limb should be in the range [0, base), the base can be any value from 2 to 2^32
+// A normalized limb vector has no zero limb at the end, so zero is represented by an empty vector
+class NumberKernel
+{
+public:
+    typedef std::vector<uint32_t> Limbs;
+
+    // Remove zero limbs at the most significant end
+    static void trim(Limbs& a);
+    // Compare two normalized limb vectors, return -1 if a < b, 0 if a == b, 1 if a > b
+    static int compare(const Limbs& a, const Limbs& b);
+    // Calculate a + b
+    static Limbs add(const Limbs& a, const Limbs& b, uint64_t base);
+    // Calculate a - b, a must not be less than b
+    static Limbs subtract(const Limbs& a, const Limbs& b, uint64_t base);
+    // Add x * base^shift to r in place
+    static void addShifted(Limbs& r, const Limbs& x, size_t shift, uint64_t base);
+    // Subtract x from r in place, r must not be less than x
+    static void subtractInPlace(Limbs& r, const Limbs& x, uint64_t base);
+    // Calculate a * m, m should be less than 2^32
+    static Limbs multiplySmall(const Limbs& a, uint64_t m, uint64_t base);
+    // Calculate a * b, choose schoolbook, Karatsuba or NTT according to the operand size
+    static Limbs multiply(const Limbs& a, const Limbs& b, uint64_t base);
+    // Multiply all items together with a balanced product tree, the items will be destroyed
+    static Limbs product(std::vector<Limbs>& items, uint64_t base);
+    // Calculate a / d and store a % d to remainder if it is not nullptr, d should be in [1, 2^32)
+    static Limbs divideSmall(const Limbs& a, uint64_t d, uint64_t base, uint64_t* remainder);
+    // Calculate a / b and a % b with Knuth's algorithm D, b must not be zero, pass nullptr if the result is not needed
+    static void divide(const Limbs& a, const Limbs& b, uint64_t base, Limbs* quotient, Limbs* remainder);
+    // Greatest common divisor with Lehmer's algorithm, finish with binary GCD once the values fit in a machine word
+    static Limbs gcd(Limbs a, Limbs b, uint64_t base);
+    // Convert to a machine word, return false if the value is not less than 2^64
+    static bool toWord(const Limbs& a, uint64_t base, uint64_t* word);
+    // Convert a machine word to limbs
+    static Limbs fromWord(uint64_t word, uint64_t base);
+    // Convert limbs in base from to limbs in base to, linear if both bases are powers of two
+    // Otherwise the halves are converted recursively and joined with a cached power of from, O(M(n) * log(n))
+    static Limbs convert(const Limbs& a, uint64_t from, uint64_t to);
+
+    // Run large multiplications on a thread pool: Karatsuba sub-products, NTT butterflies and product tree branches
+    // threads = 1 goes back to serial execution, threads = 0 uses every hardware thread, isPinned binds each worker to one processor
+    // threshold = 0 keeps the current parallel threshold, which may come from loadThresholds() or setThresholds()
+    // Do not call it while another thread is using the kernel
+    static void setParallel(unsigned int threads, size_t threshold = 0, bool isPinned = false);
+    // Number of worker threads, 0 if the kernel runs serially
+    static size_t getParallelThreads();
+    // The thread pool of setParallel(), nullptr if the kernel runs serially; column, dot product, sort and load operations share it
+    static ThreadPool* getPool();
+
+    // Algorithm crossover points in limbs, do not change them while another thread is using the kernel
+    static void setThresholds(size_t karatsuba, size_t ntt, size_t parallel);
+    static void setRadixThreshold(size_t radix);
+    static size_t getKaratsubaThreshold();
+    static size_t getNttThreshold();
+    static size_t getParallelThreshold();
+    static size_t getRadixThreshold();
+    // Read "NAME value" lines written by tools/tuneup, '#' starts a comment, unknown names are ignored
+    // Return false if the file cannot be read or a value is invalid, the thresholds are unchanged in that case
+    static bool loadThresholds(const std::string& path);
+    // Write the current thresholds in the format read by loadThresholds(), return false if failed
+    static bool saveThresholds(const std::string& path);
+
+private:
+    static std::unique_ptr<ThreadPool> pool;
+    static size_t karatsubaThreshold;
+    static size_t nttThreshold;
+    static size_t parallelThreshold;
+    static size_t radixThreshold;
+
+    // The thread pool if the operands are large enough to be split, nullptr otherwise
+    static ThreadPool* poolFor(size_t limbs);
+    // O(n*m), the fastest for short operands
+    static Limbs multiplySchoolbook(const Limbs& a, const Limbs& b, uint64_t base);
+    // O(n^1.585), operands should have similar length
+    static Limbs multiplyKaratsuba(const Limbs& a, const Limbs& b, uint64_t base);
+    // O(n*log(n)), base must not be greater than 65536
+    static Limbs multiplyNTT(const Limbs& a, const Limbs& b, uint64_t base);
+    // In-place number theoretic transform modulo a NTT friendly prime
+    static void ntt(std::vector<uint32_t>& a, bool invert, uint32_t mod, uint32_t root);
+    // Multiply items[first, last) together
+    static Limbs productRange(std::vector<Limbs>& items, size_t first, size_t last, uint64_t base);
+    // Stein's algorithm on machine words
+    static uint64_t binaryGcd(uint64_t a, uint64_t b);
+    // from^(2^k) in base to for k = 0, 1, ..., count - 1, the table of each pair of bases is cached and extended on demand
+    static std::vector<std::shared_ptr<const Limbs>> radixPowers(uint64_t from, uint64_t to, size_t count);
+    // Convert a[first, last) with the power table
+    static Limbs convertRange(const Limbs& a, size_t first, size_t last, uint64_t from, uint64_t to, const std::vector<std::shared_ptr<const Limbs>>& powers);
+    // Calculate |ca * a - cb * b| for Lehmer's algorithm, ca and cb should be less than 2^32
+    static Limbs combine(const Limbs& a, uint64_t ca, const Limbs& b, uint64_t cb, uint64_t base);
+};
@@ -0,0 +1,305 @@
+#include "NumberLoader.h"
+#include "ThreadPool.h"
+
+#include <cstring>
+
+static bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+NumberLoader::NumberLoader(char separator, bool hasHeader)
+{
+    this->separator = separator;
+    this->hasHeader = hasHeader;
+}
+
+bool NumberLoader::parseValue(const char* begin, const char* end, Column& column)
+{
+    while (begin < end && isBlank(*begin))
+    {
+        begin++;
+    }
+    while (end > begin && isBlank(end[-1]))
+    {
+        end--;
+    }
+    if (end - begin >= 2 && *begin == '"' && end[-1] == '"')
+    {
+        begin++;
+        end--;
+    }
+    bool isNegative = false;
+    if (begin < end && (*begin == '-' || *begin == '+'))
+    {
+        isNegative = (*begin == '-');
+        begin++;
+    }
+    // Split into integer and decimal digits
+    const char* point = begin;
+    while (point < end && *point >= '0' && *point <= '9')
+    {
+        point++;
+    }
+    const char* decimalBegin = point;
+    const char* decimalEnd = point;
+    if (point < end)
+    {
+        if (*point != '.')
+        {
+            return false;
+        }
+        decimalBegin = point + 1;
+        decimalEnd = decimalBegin;
+        while (decimalEnd < end && *decimalEnd >= '0' && *decimalEnd <= '9')
+        {
+            decimalEnd++;
+        }
+        if (decimalEnd != end)
+        {
+            return false;
+        }
+    }
+    if (point == begin && decimalEnd == decimalBegin)
+    {
+        return false;
+    }
+    // Same decimalLength as Number(std::string), then strip to the normalized digits
+    size_t decimalLength = (size_t)(decimalEnd - decimalBegin) > DEFAULT_LENGTH ? (size_t)(decimalEnd - decimalBegin) : DEFAULT_LENGTH;
+    while (point - begin > 1 && *begin == '0')
+    {
+        begin++;
+    }
+    while (decimalEnd > decimalBegin && decimalEnd[-1] == '0')
+    {
+        decimalEnd--;
+    }
+    size_t primarySize = point - begin;
+    size_t decimalSize = decimalEnd - decimalBegin;
+    if (primarySize == 0 || (primarySize == 1 && *begin == '0' && decimalSize == 0))
+    {
+        isNegative = isNegative && decimalSize > 0;
+    }
+    size_t totalDigits = (primarySize > 0 ? primarySize : 1) + decimalSize;
+
+    size_t offset = column.arena.size();
+    column.arena.resize(offset + NumberRecord::size(totalDigits), 0);
+    unsigned char* p = column.arena.data() + offset;
+    NumberRecord::writeHeader(p, isNegative, decimalLength, totalDigits - decimalSize, decimalSize);
+    unsigned char* digits = p + NUMBER_RECORD_HEADER_SIZE;
+    // A missing integer part is the digit 0, which is already in the zeroed record
+    size_t i = primarySize > 0 ? 0 : 1;
+    for (const char* c = begin; c < point; c++, i++)
+    {
+        digits[i / 2] |= (unsigned char)((i % 2 == 0) ? ((*c - '0') << 4) : (*c - '0'));
+    }
+    for (const char* c = decimalBegin; c < decimalEnd; c++, i++)
+    {
+        digits[i / 2] |= (unsigned char)((i % 2 == 0) ? ((*c - '0') << 4) : (*c - '0'));
+    }
+    column.offsets.push_back(offset);
+    return true;
+}
+
+void NumberLoader::parseChunk(const char* data, size_t begin, size_t end, char separator, const std::vector<size_t>& fields, Part& part)
+{
+    size_t lastField = 0;
+    for (size_t field : fields)
+    {
+        lastField = field > lastField ? field : lastField;
+    }
+    part.columns.assign(fields.size(), Column());
+    std::vector<const char*> fieldBegin(lastField + 1);
+    std::vector<const char*> fieldEnd(lastField + 1);
+    size_t position = begin;
+    while (position < end)
+    {
+        const char* line = data + position;
+        const char* lineEnd = (const char*)memchr(line, '\n', end - position);
+        lineEnd = lineEnd != nullptr ? lineEnd : data + end;
+        size_t next = lineEnd - data + 1;
+        // Empty lines are not rows
+        const char* c = line;
+        while (c < lineEnd && isBlank(*c))
+        {
+            c++;
+        }
+        if (c == lineEnd)
+        {
+            position = next;
+            continue;
+        }
+        // Locate the fields up to the last selected one
+        size_t count = 0;
+        const char* field = line;
+        while (count <= lastField)
+        {
+            const char* fieldStop = (const char*)memchr(field, separator, lineEnd - field);
+            fieldStop = fieldStop != nullptr ? fieldStop : lineEnd;
+            fieldBegin[count] = field;
+            fieldEnd[count] = fieldStop;
+            count++;
+            if (fieldStop == lineEnd)
+            {
+                break;
+            }
+            field = fieldStop + 1;
+        }
+        // Parse the selected fields, and roll the row back if one of them fails
+        size_t failed = SIZE_MAX;
+        for (size_t i = 0; i < fields.size(); i++)
+        {
+            if (fields[i] >= count || parseValue(fieldBegin[fields[i]], fieldEnd[fields[i]], part.columns[i]) == false)
+            {
+                failed = i;
+                break;
+            }
+        }
+        if (failed != SIZE_MAX)
+        {
+            for (size_t i = 0; i < failed; i++)
+            {
+                part.columns[i].arena.resize(part.columns[i].offsets.back());
+                part.columns[i].offsets.pop_back();
+            }
+            part.errors.push_back({ (uint64_t)position, fields[failed] });
+        }
+        position = next;
+    }
+}
+
+// Call body(t) for every part in [0, parts), on the pool if there is one
+static void forParts(ThreadPool* pool, size_t parts, const std::function<void(size_t)>& body)
+{
+    if (pool == nullptr)
+    {
+        for (size_t t = 0; t < parts; t++)
+        {
+            body(t);
+        }
+        return;
+    }
+    pool->parallelFor(0, parts, 1, [&body](size_t begin, size_t end)
+    {
+        for (size_t t = begin; t < end; t++)
+        {
+            body(t);
+        }
+    });
+}
+
+bool NumberLoader::load(const std::string& path, const std::vector<size_t>& fields)
+{
+    this->columns.assign(fields.size(), Column());
+    this->errors.clear();
+    MappedFile file;
+    if (file.open(path) == false)
+    {
+        return false;
+    }
+    if (fields.size() == 0 || file.size() == 0)
+    {
+        return true;
+    }
+    const char* data = (const char*)file.data();
+    size_t size = file.size();
+    size_t start = 0;
+    if (this->hasHeader)
+    {
+        const char* headerEnd = (const char*)memchr(data, '\n', size);
+        start = headerEnd != nullptr ? headerEnd - data + 1 : size;
+    }
+
+    // Split at line boundaries, one part per thread of the pool and the calling thread
+    ThreadPool* pool = NumberKernel::getPool();
+    size_t threads = pool != nullptr ? pool->size() + 1 : 1;
+    size_t maxThreads = (size - start) / NUMBER_LOADER_CHUNK_SIZE + 1;
+    threads = threads < maxThreads ? threads : maxThreads;
+    pool = threads > 1 ? pool : nullptr;
+    std::vector<size_t> bounds(threads + 1);
+    bounds[0] = start;
+    bounds[threads] = size;
+    for (size_t t = 1; t < threads; t++)
+    {
+        size_t bound = start + (size - start) / threads * t;
+        bound = bound > bounds[t - 1] ? bound : bounds[t - 1];
+        const char* lineEnd = (const char*)memchr(data + bound, '\n', size - bound);
+        bounds[t] = lineEnd != nullptr ? lineEnd - data + 1 : size;
+    }
+
+    std::vector<Part> parts(threads);
+    forParts(pool, threads, [&](size_t t)
+    {
+        parseChunk(data, bounds[t], bounds[t + 1], this->separator, fields, parts[t]);
+    });
+
+    // Concatenate the parts, each thread copies its own part into place
+    std::vector<std::vector<size_t>> arenaStart(fields.size(), std::vector<size_t>(threads + 1, 0));
+    std::vector<size_t> rowStart(threads + 1, 0);
+    for (size_t t = 0; t < threads; t++)
+    {
+        rowStart[t + 1] = rowStart[t] + parts[t].columns[0].offsets.size();
+        for (size_t i = 0; i < fields.size(); i++)
+        {
+            arenaStart[i][t + 1] = arenaStart[i][t] + parts[t].columns[i].arena.size();
+        }
+    }
+    for (size_t i = 0; i < fields.size(); i++)
+    {
+        this->columns[i].arena.resize(arenaStart[i][threads]);
+        this->columns[i].offsets.resize(rowStart[threads]);
+    }
+    forParts(pool, threads, [&](size_t t)
+    {
+        for (size_t i = 0; i < fields.size(); i++)
+        {
+            Column& source = parts[t].columns[i];
+            Column& target = this->columns[i];
+            if (source.arena.size() > 0)
+            {
+                memcpy(target.arena.data() + arenaStart[i][t], source.arena.data(), source.arena.size());
+            }
+            for (size_t row = 0; row < source.offsets.size(); row++)
+            {
+                target.offsets[rowStart[t] + row] = source.offsets[row] + arenaStart[i][t];
+            }
+            source = Column();
+        }
+    });
+    for (const Part& part : parts)
+    {
+        this->errors.insert(this->errors.end(), part.errors.begin(), part.errors.end());
+    }
+    return true;
+}
+
+size_t NumberLoader::size() const
+{
+    return this->columns.size() > 0 ? this->columns[0].offsets.size() : 0;
+}
+
+size_t NumberLoader::columnCount() const
+{
+    return this->columns.size();
+}
+
+NumberView NumberLoader::at(size_t row, size_t column) const
+{
+    return NumberView(this->columns[column].arena.data() + this->columns[column].offsets[row]);
+}
+
+std::vector<Number> NumberLoader::read(size_t column) const
+{
+    std::vector<Number> result;
+    result.reserve(this->size());
+    for (size_t row = 0; row < this->size(); row++)
+    {
+        result.push_back(this->at(row, column).toNumber());
+    }
+    return result;
+}
+
+const std::vector<NumberLoadError>& NumberLoader::getErrors() const
+{
+    return this->errors;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "Number.h"
+#include "NumberFile.h"
+#include "MappedFile.h"
+
+// Chunks smaller than this are not split across threads
+#define NUMBER_LOADER_CHUNK_SIZE (1 << 20)
+
+// A row which could not be loaded
+struct NumberLoadError
+{
+    // Byte offset of the start of the row in the file
+    uint64_t offset;
+    // Field index of the bad or missing value
+    size_t column;
+};
+
+// Load decimal columns of a CSV or text file, the file is mapped and split into chunks at line boundaries which are parsed in parallel
+// Values are parsed straight into records of the NumberFile format, one contiguous arena per column, and are read as NumberView
+// A value is an optional sign, digits and an optional decimal point with more digits, surrounding blanks and quotes are ignored
+// Malformed rows are skipped as a whole, so the columns stay aligned, and reported by offset
+class NumberLoader
+{
+private:
+    struct Column
+    {
+        std::vector<unsigned char> arena;
+        std::vector<uint64_t> offsets;
+    };
+
+    // Result of parsing one chunk of the file
+    struct Part
+    {
+        std::vector<Column> columns;
+        std::vector<NumberLoadError> errors;
+    };
+
+    char separator;
+    bool hasHeader;
+    std::vector<Column> columns;
+    std::vector<NumberLoadError> errors;
+
+    // Parse the lines in [begin, end), fields lists the selected field index of each column
+    static void parseChunk(const char* data, size_t begin, size_t end, char separator, const std::vector<size_t>& fields, Part& part);
+    // Append the value in [begin, end) as a record, return false if it is not a number
+    static bool parseValue(const char* begin, const char* end, Column& column);
+
+public:
+    // separator splits the fields of a line, set hasHeader to skip the first line
+    NumberLoader(char separator = ',', bool hasHeader = false);
+
+    // Load the given fields (0 is the first field) of every line, the previous data will be discarded
+    // Chunks are parsed on the thread pool of NumberKernel::setParallel(), return false if the file cannot be mapped
+    bool load(const std::string& path, const std::vector<size_t>& fields = { 0 });
+    // Number of rows loaded
+    size_t size() const;
+    // Number of loaded columns, in the order of the fields passed to load()
+    size_t columnCount() const;
+    // View of a value, valid until the next load() or the destruction of the loader
+    NumberView at(size_t row, size_t column = 0) const;
+    // Decode a whole column
+    std::vector<Number> read(size_t column = 0) const;
+    // Rows skipped by the last load(), ordered by offset
+    const std::vector<NumberLoadError>& getErrors() const;
+};
@@ -0,0 +1,374 @@
+#include "NumberRandom.h"
+
+#include <stdexcept>
+
+// 10^16, a 64-bit word below a multiple of it gives 16 uniform digits
+static const uint64_t DIGIT_BLOCK = 10000000000000000ULL;
+static const uint64_t DIGIT_BLOCK_LIMIT = UINT64_MAX - UINT64_MAX % DIGIT_BLOCK;
+
+static uint64_t rotateLeft(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+NumberRandom::NumberRandom(uint64_t seed)
+{
+    this->seed(seed);
+}
+
+void NumberRandom::seed(uint64_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        value += 0x9E3779B97F4A7C15ULL;
+        uint64_t z = value;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        this->state[i] = z ^ (z >> 31);
+    }
+}
+
+uint64_t NumberRandom::operator () ()
+{
+    uint64_t* s = this->state;
+    uint64_t result = rotateLeft(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotateLeft(s[3], 45);
+    return result;
+}
+
+void NumberRandom::jump()
+{
+    static const uint64_t JUMP[4] = { 0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL, 0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL };
+    uint64_t next[4] = { 0, 0, 0, 0 };
+    for (int i = 0; i < 4; i++)
+    {
+        for (int b = 0; b < 64; b++)
+        {
+            if (JUMP[i] & ((uint64_t)1 << b))
+            {
+                for (int k = 0; k < 4; k++)
+                {
+                    next[k] ^= this->state[k];
+                }
+            }
+            (*this)();
+        }
+    }
+    for (int k = 0; k < 4; k++)
+    {
+        this->state[k] = next[k];
+    }
+}
+
+NumberRandom::WordSource NumberRandom::source()
+{
+    return [this]() { return (*this)(); };
+}
+
+void NumberRandom::randomDigits(const WordSource& next, int* digits, size_t count)
+{
+    size_t i = 0;
+    while (i < count)
+    {
+        uint64_t word = next();
+        if (word >= DIGIT_BLOCK_LIMIT)
+        {
+            continue;
+        }
+        word %= DIGIT_BLOCK;
+        for (int k = 0; k < 16 && i < count; k++, i++)
+        {
+            digits[i] = (int)(word % 10);
+            word /= 10;
+        }
+    }
+}
+
+uint64_t NumberRandom::randomBelow(const WordSource& next, uint64_t bound)
+{
+    uint64_t limit = UINT64_MAX - UINT64_MAX % bound;
+    uint64_t word = next();
+    while (word >= limit)
+    {
+        word = next();
+    }
+    return word % bound;
+}
+
+void NumberRandom::setDigits(const WordSource& next, Number& n, size_t count)
+{
+    n.isNegative = false;
+    n.decimal.clear();
+    n.decimalLength = DEFAULT_LENGTH;
+    n.resetHash();
+    if (count == 0)
+    {
+        n.primary.assign(1, 0);
+        return;
+    }
+    n.primary.resize(count);
+    n.primary[0] = (int)randomBelow(next, 9) + 1;
+    randomDigits(next, n.primary.data() + 1, count - 1);
+}
+
+void NumberRandom::setDecimal(const WordSource& next, Number& n, size_t integerDigits, size_t scale, bool isSigned)
+{
+    n.isNegative = isSigned && (randomBelow(next, 2) == 1);
+    n.decimalLength = scale > DEFAULT_LENGTH ? scale : DEFAULT_LENGTH;
+    n.resetHash();
+    n.primary.resize(integerDigits > 0 ? integerDigits : 1);
+    n.decimal.resize(scale);
+    randomDigits(next, n.primary.data(), integerDigits);
+    if (integerDigits == 0)
+    {
+        n.primary[0] = 0;
+    }
+    randomDigits(next, n.decimal.data(), scale);
+    // Normalize without moving digits more than needed
+    size_t first = 0;
+    while (first + 1 < n.primary.size() && n.primary[first] == 0)
+    {
+        first++;
+    }
+    n.primary.erase(n.primary.begin(), n.primary.begin() + first);
+    while (n.decimal.size() > 0 && n.decimal.back() == 0)
+    {
+        n.decimal.pop_back();
+    }
+    if (n.isZero())
+    {
+        n.isNegative = false;
+    }
+}
+
+struct NumberRandom::UniformRange
+{
+    // k is drawn below bound, base LIMB_BASE limbs with the lowest limb first
+    NumberKernel::Limbs bound;
+    // Values are summed as value * 10^scale in decimal digits, the lowest digit first
+    // scale is the larger one of the requested scale and the decimal digits of lo, k is shifted up by shift digits
+    size_t scale;
+    size_t shift;
+    // |lo| * 10^scale
+    std::vector<int> low;
+    bool isLowNegative;
+    size_t decimalLength;
+    // Scratch buffers of one value
+    NumberKernel::Limbs k;
+    std::vector<int> digits;
+};
+
+void NumberRandom::setRange(const Number& lo, const Number& hi, size_t scale, UniformRange& range)
+{
+    if (hi <= lo)
+    {
+        throw std::domain_error("NumberRandom: the range is empty");
+    }
+    // The result is lo + k / 10^scale with k uniform in [0, ceil((hi - lo) * 10^scale))
+    Number difference = hi - lo;
+    if (difference.decimal.size() <= scale)
+    {
+        range.bound = difference.toLimbs(scale - difference.decimal.size());
+    }
+    else
+    {
+        NumberKernel::Limbs power(1, 1);
+        for (size_t i = scale; i < difference.decimal.size(); i++)
+        {
+            power = NumberKernel::multiplySmall(power, 10, LIMB_BASE);
+        }
+        NumberKernel::Limbs remainder;
+        NumberKernel::divide(difference.toLimbs(), power, LIMB_BASE, &range.bound, &remainder);
+        if (remainder.size() > 0)
+        {
+            range.bound = NumberKernel::add(range.bound, NumberKernel::Limbs(1, 1), LIMB_BASE);
+        }
+    }
+    range.scale = lo.decimal.size() > scale ? lo.decimal.size() : scale;
+    range.shift = range.scale - scale;
+    range.low.assign(range.scale + lo.primary.size(), 0);
+    for (size_t i = 0; i < lo.decimal.size(); i++)
+    {
+        range.low[range.scale - 1 - i] = lo.decimal[i];
+    }
+    for (size_t i = 0; i < lo.primary.size(); i++)
+    {
+        range.low[range.scale + lo.primary.size() - 1 - i] = lo.primary[i];
+    }
+    range.isLowNegative = lo.isNegative;
+    size_t decimalLength = lo.decimalLength > hi.decimalLength ? lo.decimalLength : hi.decimalLength;
+    range.decimalLength = scale > decimalLength ? scale : decimalLength;
+    range.k.resize(range.bound.size());
+    size_t kDigits = range.shift + range.bound.size() * LIMB_DIGITS;
+    range.digits.resize((range.low.size() > kDigits ? range.low.size() : kDigits) + 1);
+}
+
+void NumberRandom::setUniform(const WordSource& next, UniformRange& range, Number& n)
+{
+    // Rejection sampling: draw the top limb in [0, top] and the others freely until the value is below the bound
+    NumberKernel::Limbs& k = range.k;
+    const NumberKernel::Limbs& bound = range.bound;
+    int digits[16];
+    while (true)
+    {
+        for (size_t i = 0; i + 1 < k.size(); i += 4)
+        {
+            randomDigits(next, digits, 16);
+            for (size_t j = 0; j < 4 && i + j + 1 < k.size(); j++)
+            {
+                k[i + j] = (uint32_t)(digits[4 * j] + 10 * digits[4 * j + 1] + 100 * digits[4 * j + 2] + 1000 * digits[4 * j + 3]);
+            }
+        }
+        k.back() = (uint32_t)randomBelow(next, (uint64_t)bound.back() + 1);
+        size_t i = k.size();
+        while (i > 0 && k[i - 1] == bound[i - 1])
+        {
+            i--;
+        }
+        if (i > 0 && k[i - 1] < bound[i - 1])
+        {
+            break;
+        }
+    }
+
+    // Decimal digit i of k * 10^shift and of |lo| * 10^scale
+    static const uint32_t POWERS[LIMB_DIGITS] = { 1, 10, 100, 1000 };
+    auto kDigit = [&](size_t i) -> int
+    {
+        if (i < range.shift || (i - range.shift) / LIMB_DIGITS >= k.size())
+        {
+            return 0;
+        }
+        size_t j = i - range.shift;
+        return (int)(k[j / LIMB_DIGITS] / POWERS[j % LIMB_DIGITS] % 10);
+    };
+    auto lowDigit = [&](size_t i) -> int
+    {
+        return i < range.low.size() ? range.low[i] : 0;
+    };
+    // Add k to a positive lo, or subtract the smaller magnitude from the larger one for a negative lo
+    std::vector<int>& sum = range.digits;
+    size_t size = sum.size();
+    bool isNegative = false;
+    if (range.isLowNegative == false)
+    {
+        int carry = 0;
+        for (size_t i = 0; i < size; i++)
+        {
+            int t = lowDigit(i) + kDigit(i) + carry;
+            carry = t >= 10 ? 1 : 0;
+            sum[i] = t - carry * 10;
+        }
+    }
+    else
+    {
+        size_t i = size;
+        while (i > 0 && lowDigit(i - 1) == kDigit(i - 1))
+        {
+            i--;
+        }
+        isNegative = i > 0 && lowDigit(i - 1) > kDigit(i - 1);
+        int borrow = 0;
+        for (size_t j = 0; j < size; j++)
+        {
+            int t = isNegative ? lowDigit(j) - kDigit(j) - borrow : kDigit(j) - lowDigit(j) - borrow;
+            borrow = t < 0 ? 1 : 0;
+            sum[j] = t + borrow * 10;
+        }
+    }
+
+    // Write the digits into n without leading integer zeros and ending decimal zeros
+    size_t top = size;
+    while (top > range.scale + 1 && sum[top - 1] == 0)
+    {
+        top--;
+    }
+    size_t lowest = 0;
+    while (lowest < range.scale && sum[lowest] == 0)
+    {
+        lowest++;
+    }
+    n.primary.resize(top - range.scale);
+    for (size_t i = 0; i < n.primary.size(); i++)
+    {
+        n.primary[i] = sum[top - 1 - i];
+    }
+    n.decimal.resize(range.scale - lowest);
+    for (size_t i = 0; i < n.decimal.size(); i++)
+    {
+        n.decimal[i] = sum[range.scale - 1 - i];
+    }
+    n.isNegative = isNegative;
+    n.decimalLength = range.decimalLength;
+    n.resetHash();
+    if (n.isZero())
+    {
+        n.isNegative = false;
+    }
+}
+
+Number NumberRandom::randomUniform(const WordSource& next, const Number& lo, const Number& hi, size_t scale)
+{
+    UniformRange range;
+    setRange(lo, hi, scale, range);
+    Number result;
+    setUniform(next, range, result);
+    return result;
+}
+
+Number NumberRandom::digits(size_t count)
+{
+    Number result;
+    setDigits(this->source(), result, count);
+    return result;
+}
+
+Number NumberRandom::uniform(const Number& lo, const Number& hi, size_t scale)
+{
+    return randomUniform(this->source(), lo, hi, scale);
+}
+
+Number NumberRandom::decimal(size_t integerDigits, size_t scale, bool isSigned)
+{
+    Number result;
+    setDecimal(this->source(), result, integerDigits, scale, isSigned);
+    return result;
+}
+
+void NumberRandom::fillDigits(std::vector<Number>& numbers, size_t count, size_t digits)
+{
+    numbers.resize(count);
+    WordSource next = this->source();
+    for (Number& n : numbers)
+    {
+        setDigits(next, n, digits);
+    }
+}
+
+void NumberRandom::fillDecimal(std::vector<Number>& numbers, size_t count, size_t integerDigits, size_t scale, bool isSigned)
+{
+    numbers.resize(count);
+    WordSource next = this->source();
+    for (Number& n : numbers)
+    {
+        setDecimal(next, n, integerDigits, scale, isSigned);
+    }
+}
+
+void NumberRandom::fillUniform(std::vector<Number>& numbers, size_t count, const Number& lo, const Number& hi, size_t scale)
+{
+    UniformRange range;
+    setRange(lo, hi, scale, range);
+    numbers.resize(count);
+    WordSource next = this->source();
+    for (Number& n : numbers)
+    {
+        setUniform(next, range, n);
+    }
+}
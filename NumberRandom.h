@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
+#include "Number.h"
+
+#define NUMBER_RANDOM_DEFAULT_SEED 0x9E3779B97F4A7C15ULL
+
+// Random Number generation with the xoshiro256** generator, digits are drawn 16 at a time from 64-bit words
+// The class is itself a uniform random bit generator, so it can also drive the standard distributions
+// The static templates accept any uniform random bit generator instead, such as std::mt19937_64
+// An instance is not thread-safe, give each thread its own instance, for example seeded alike and advanced with jump()
+class NumberRandom
+{
+private:
+    uint64_t state[4];
+
+    // Source of uniform 64-bit words
+    typedef std::function<uint64_t()> WordSource;
+    // Range of uniform values calculated once, with scratch buffers reused by every value, defined in NumberRandom.cpp
+    struct UniformRange;
+
+    // Fill count uniform decimal digits
+    static void randomDigits(const WordSource& next, int* digits, size_t count);
+    // Uniform integer in [0, bound), bound must not be zero
+    static uint64_t randomBelow(const WordSource& next, uint64_t bound);
+    // Write a uniform integer with count digits into n without allocating if n has the capacity
+    static void setDigits(const WordSource& next, Number& n, size_t count);
+    // Write a uniform value in [0, 10^integerDigits) with scale decimal digits into n, negative half of the time if isSigned
+    static void setDecimal(const WordSource& next, Number& n, size_t integerDigits, size_t scale, bool isSigned);
+    // Prepare the values lo + k / 10^scale with k uniform in [0, ceil((hi - lo) * 10^scale)), throw std::domain_error if hi <= lo
+    static void setRange(const Number& lo, const Number& hi, size_t scale, UniformRange& range);
+    // Write a uniform value of the range into n without allocating if n has the capacity
+    static void setUniform(const WordSource& next, UniformRange& range, Number& n);
+    static Number randomUniform(const WordSource& next, const Number& lo, const Number& hi, size_t scale);
+    WordSource source();
+
+public:
+    typedef uint64_t result_type;
+
+    explicit NumberRandom(uint64_t seed = NUMBER_RANDOM_DEFAULT_SEED);
+    // Reset the state from a 64-bit seed with splitmix64
+    void seed(uint64_t value);
+    // Next 64 random bits
+    uint64_t operator () ();
+    // Advance the state by 2^128 steps, to split one seed into non-overlapping streams
+    void jump();
+    static constexpr uint64_t min()
+    {
+        return 0;
+    }
+    static constexpr uint64_t max()
+    {
+        return UINT64_MAX;
+    }
+
+    // Uniform integer with exactly count digits, the first digit is not zero, 0 if count is 0
+    Number digits(size_t count);
+    // Uniform value in [lo, hi) on the grid lo + k / 10^scale, throw std::domain_error if hi <= lo
+    Number uniform(const Number& lo, const Number& hi, size_t scale = 0);
+    // Uniform value in [0, 10^integerDigits) with scale decimal digits, the sign is random if isSigned is true
+    Number decimal(size_t integerDigits, size_t scale, bool isSigned = false);
+
+    // Bulk generation, existing elements are overwritten in place and keep their digit buffers, so refilling a vector does not allocate for each value
+    // Resize numbers to count values with exactly digits digits each
+    void fillDigits(std::vector<Number>& numbers, size_t count, size_t digits);
+    // Resize numbers to count values like decimal()
+    void fillDecimal(std::vector<Number>& numbers, size_t count, size_t integerDigits, size_t scale, bool isSigned = false);
+    // Resize numbers to count values like uniform()
+    void fillUniform(std::vector<Number>& numbers, size_t count, const Number& lo, const Number& hi, size_t scale = 0);
+
+    // The same generators driven by any uniform random bit generator
+    template <typename Generator>
+    static Number digitsFrom(Generator& generator, size_t count);
+    template <typename Generator>
+    static Number uniformFrom(Generator& generator, const Number& lo, const Number& hi, size_t scale = 0);
+    template <typename Generator>
+    static Number decimalFrom(Generator& generator, size_t integerDigits, size_t scale, bool isSigned = false);
+};
+
+template <typename Generator>
+Number NumberRandom::digitsFrom(Generator& generator, size_t count)
+{
+    std::uniform_int_distribution<uint64_t> word;
+    Number result;
+    setDigits([&]() { return word(generator); }, result, count);
+    return result;
+}
+
+template <typename Generator>
+Number NumberRandom::uniformFrom(Generator& generator, const Number& lo, const Number& hi, size_t scale)
+{
+    std::uniform_int_distribution<uint64_t> word;
+    return randomUniform([&]() { return word(generator); }, lo, hi, scale);
+}
+
+template <typename Generator>
+Number NumberRandom::decimalFrom(Generator& generator, size_t integerDigits, size_t scale, bool isSigned)
+{
+    std::uniform_int_distribution<uint64_t> word;
+    Number result;
+    setDecimal([&]() { return word(generator); }, result, integerDigits, scale, isSigned);
+    return result;
+}
@@ -0,0 +1,271 @@
+#include "NumberSort.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+
+void NumberSort::encode(const Number& n, std::string& key)
+{
+    // Digits are indexed over the integer part followed by the decimal part
+    size_t primarySize = n.primary.size();
+    size_t totalDigits = primarySize + n.decimal.size();
+    auto digit = [&](size_t i)
+    {
+        return i < primarySize ? n.primary[i] : n.decimal[i - primarySize];
+    };
+    size_t first = 0;
+    while (first < totalDigits && digit(first) == 0)
+    {
+        first++;
+    }
+    if (first == totalDigits)
+    {
+        key += (char)0x02;
+        return;
+    }
+    size_t last = totalDigits;
+    while (digit(last - 1) == 0)
+    {
+        last--;
+    }
+    bool isNegative = n.isNegative;
+    unsigned char mask = isNegative ? 0xFF : 0x00;
+    key += (char)(isNegative ? 0x01 : 0x03);
+
+    // Exponent: a length byte around 0x80, then the magnitude in big-endian
+    bool isExponentNegative = first >= primarySize;
+    uint64_t exponent = isExponentNegative ? (uint64_t)(first - primarySize) : (uint64_t)(primarySize - first);
+    int exponentBytes = 0;
+    while (exponentBytes < 8 && (exponent >> (8 * exponentBytes)) > 0)
+    {
+        exponentBytes++;
+    }
+    unsigned char exponentMask = isExponentNegative ? 0xFF : 0x00;
+    key += (char)((isExponentNegative ? 0x80 - exponentBytes : 0x80 + exponentBytes) ^ mask);
+    for (int i = exponentBytes - 1; i >= 0; i--)
+    {
+        key += (char)(((unsigned char)(exponent >> (8 * i)) ^ exponentMask) ^ mask);
+    }
+
+    // Two digits per byte, a missing last digit is the same as a zero digit
+    for (size_t i = first; i < last; i += 2)
+    {
+        int high = digit(i);
+        int low = i + 1 < last ? digit(i + 1) : 0;
+        key += (char)((unsigned char)(high * 10 + low + 1) ^ mask);
+    }
+    key += (char)mask;
+}
+
+std::string NumberSort::encode(const Number& n)
+{
+    std::string key;
+    encode(n, key);
+    return key;
+}
+
+void NumberSort::encodeRange(const std::vector<Number>& numbers, size_t first, size_t last, std::string& buffer, Item* items)
+{
+    buffer.clear();
+    std::vector<size_t> offsets(last - first + 1);
+    for (size_t i = first; i < last; i++)
+    {
+        offsets[i - first] = buffer.size();
+        encode(numbers[i], buffer);
+    }
+    offsets[last - first] = buffer.size();
+    // The buffer does not move any more, so the pointers stay valid
+    const unsigned char* base = (const unsigned char*)buffer.data();
+    for (size_t i = first; i < last; i++)
+    {
+        items[i - first].key = base + offsets[i - first];
+        items[i - first].length = offsets[i - first + 1] - offsets[i - first];
+        items[i - first].index = i;
+    }
+}
+
+int NumberSort::bucket(const Item& item, size_t depth)
+{
+    return depth < item.length ? item.key[depth] + 1 : 0;
+}
+
+bool NumberSort::isLess(const Item& a, const Item& b, size_t depth)
+{
+    size_t length = a.length < b.length ? a.length : b.length;
+    int result = length > depth ? memcmp(a.key + depth, b.key + depth, length - depth) : 0;
+    return result != 0 ? result < 0 : a.length < b.length;
+}
+
+void NumberSort::radixSort(Item* items, Item* buffer, size_t count, size_t depth)
+{
+    while (true)
+    {
+        if (count < NUMBER_SORT_INSERTION_THRESHOLD)
+        {
+            for (size_t i = 1; i < count; i++)
+            {
+                Item item = items[i];
+                size_t j = i;
+                while (j > 0 && isLess(item, items[j - 1], depth))
+                {
+                    items[j] = items[j - 1];
+                    j--;
+                }
+                items[j] = item;
+            }
+            return;
+        }
+        size_t counts[257] = {};
+        for (size_t i = 0; i < count; i++)
+        {
+            counts[bucket(items[i], depth)]++;
+        }
+        // All keys share this byte, go to the next one without moving anything
+        int shared = bucket(items[0], depth);
+        if (counts[shared] == count)
+        {
+            if (shared == 0)
+            {
+                return;
+            }
+            depth++;
+            continue;
+        }
+        size_t positions[257];
+        size_t position = 0;
+        for (int b = 0; b < 257; b++)
+        {
+            positions[b] = position;
+            position += counts[b];
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            buffer[positions[bucket(items[i], depth)]++] = items[i];
+        }
+        std::copy(buffer, buffer + count, items);
+        // Keys in bucket 0 have ended and are equal
+        size_t start = counts[0];
+        for (int b = 1; b < 257; b++)
+        {
+            if (counts[b] > 1)
+            {
+                radixSort(items + start, buffer + start, counts[b], depth + 1);
+            }
+            start += counts[b];
+        }
+        return;
+    }
+}
+
+void NumberSort::permute(std::vector<Number>& numbers, const std::vector<Item>& items)
+{
+    // Follow each cycle of the permutation, swapping the digit vectors instead of copying them
+    std::vector<bool> isDone(numbers.size(), false);
+    for (size_t i = 0; i < numbers.size(); i++)
+    {
+        size_t j = i;
+        while (isDone[j] == false && items[j].index != i)
+        {
+            Number& a = numbers[j];
+            Number& b = numbers[items[j].index];
+            std::swap(a.isNegative, b.isNegative);
+            a.primary.swap(b.primary);
+            a.decimal.swap(b.decimal);
+            std::swap(a.decimalLength, b.decimalLength);
+            size_t hashValue = a.hashValue.load(std::memory_order_relaxed);
+            a.hashValue.store(b.hashValue.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            b.hashValue.store(hashValue, std::memory_order_relaxed);
+            isDone[j] = true;
+            j = items[j].index;
+        }
+        isDone[j] = true;
+    }
+}
+
+void NumberSort::sort(std::vector<Number>& numbers)
+{
+    if (numbers.size() < 2)
+    {
+        return;
+    }
+    std::string keys;
+    std::vector<Item> items(numbers.size());
+    std::vector<Item> buffer(numbers.size());
+    encodeRange(numbers, 0, numbers.size(), keys, items.data());
+    radixSort(items.data(), buffer.data(), items.size(), 0);
+    permute(numbers, items);
+}
+
+void NumberSort::parallelSort(std::vector<Number>& numbers)
+{
+    ThreadPool* pool = NumberKernel::getPool();
+    if (pool == nullptr || numbers.size() < NUMBER_SORT_PARALLEL_THRESHOLD)
+    {
+        sort(numbers);
+        return;
+    }
+    // One run per thread of the pool and the calling thread, each run is encoded and sorted by one task
+    size_t runs = pool->size() + 1;
+    size_t count = numbers.size();
+    std::vector<std::string> keys(runs);
+    std::vector<Item> items(count);
+    std::vector<Item> buffer(count);
+    std::vector<size_t> bounds(runs + 1);
+    for (size_t t = 0; t <= runs; t++)
+    {
+        bounds[t] = count * t / runs;
+    }
+    pool->parallelFor(0, runs, 1, [&](size_t begin, size_t end)
+    {
+        for (size_t t = begin; t < end; t++)
+        {
+            encodeRange(numbers, bounds[t], bounds[t + 1], keys[t], items.data() + bounds[t]);
+            radixSort(items.data() + bounds[t], buffer.data() + bounds[t], bounds[t + 1] - bounds[t], 0);
+        }
+    });
+
+    // Merge neighbouring runs in parallel until one run is left
+    auto isLessKey = [](const Item& a, const Item& b)
+    {
+        return isLess(a, b, 0);
+    };
+    Item* source = items.data();
+    Item* target = buffer.data();
+    for (size_t width = 1; width < runs; width *= 2)
+    {
+        std::vector<std::function<void()>> merges;
+        for (size_t t = 0; t < runs; t += 2 * width)
+        {
+            size_t first = bounds[t];
+            size_t middle = bounds[std::min<size_t>(t + width, runs)];
+            size_t last = bounds[std::min<size_t>(t + 2 * width, runs)];
+            merges.push_back([=]()
+            {
+                std::merge(source + first, source + middle, source + middle, source + last, target + first, isLessKey);
+            });
+        }
+        pool->run(merges);
+        std::swap(source, target);
+    }
+    if (source != items.data())
+    {
+        std::copy(source, source + count, items.data());
+    }
+    permute(numbers, items);
+}
+
+std::vector<size_t> NumberSort::order(const std::vector<Number>& numbers)
+{
+    std::string keys;
+    std::vector<Item> items(numbers.size());
+    std::vector<Item> buffer(numbers.size());
+    encodeRange(numbers, 0, numbers.size(), keys, items.data());
+    radixSort(items.data(), buffer.data(), items.size(), 0);
+    std::vector<size_t> result(numbers.size());
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        result[i] = items[i].index;
+    }
+    return result;
+}
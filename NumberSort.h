@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include "Number.h"
+
+// Groups smaller than this are sorted by insertion instead of another radix pass
+#define NUMBER_SORT_INSERTION_THRESHOLD 32
+// parallelSort() falls back to sort() for fewer numbers than this
+#define NUMBER_SORT_PARALLEL_THRESHOLD 65536
+
+// Order-preserving byte keys for Number, memcmp order of two keys is the numeric order of the numbers
+// Key: class byte (0x01 negative, 0x02 zero, 0x03 positive), then for non-zero numbers the decimal exponent and the digits
+// The value is 0.d1d2d3... * 10^exponent with d1 != 0, the exponent is written as a length byte followed by its big-endian bytes
+// Digits are packed two per byte as d1 * 10 + d2 + 1 and followed by a 0x00 terminator, all bytes after the class byte are complemented for negative numbers
+// Leading zeros, ending decimal zeros and the sign of zero do not change the key
+class NumberSort
+{
+private:
+    struct Item
+    {
+        const unsigned char* key;
+        size_t length;
+        size_t index;
+    };
+
+    // Encode numbers [first, last) into one buffer and create the items pointing into it
+    static void encodeRange(const std::vector<Number>& numbers, size_t first, size_t last, std::string& buffer, Item* items);
+    // Byte at depth plus one, 0 if the key is shorter
+    static int bucket(const Item& item, size_t depth);
+    // Compare the keys starting from depth
+    static bool isLess(const Item& a, const Item& b, size_t depth);
+    // MSD radix sort, buffer must hold count items, the order of equal keys is kept
+    static void radixSort(Item* items, Item* buffer, size_t count, size_t depth);
+    // Move the numbers into the order of the items
+    static void permute(std::vector<Number>& numbers, const std::vector<Item>& items);
+
+public:
+    // Append the key of n to key
+    static void encode(const Number& n, std::string& key);
+    static std::string encode(const Number& n);
+
+    // Sort the numbers in ascending order, the order of equal numbers is kept
+    static void sort(std::vector<Number>& numbers);
+    // Sort on the thread pool of NumberKernel::setParallel(), same as sort() if the kernel runs serially
+    static void parallelSort(std::vector<Number>& numbers);
+    // Indices which sort the numbers, the numbers are not modified
+    static std::vector<size_t> order(const std::vector<Number>& numbers);
+};
@@ -0,0 +1,143 @@
+#include "NumberStats.h"
+
+#include <algorithm>
+
+std::mutex NumberStats::registryMutex;
+std::vector<NumberStats::Counters*> NumberStats::registry;
+NumberStats::Snapshot NumberStats::retired = {};
+// Bytes are shared by all threads, since memory may be freed by another thread than the one which allocated it
+static std::atomic<uint64_t> currentBytes(0);
+static std::atomic<uint64_t> peakBytes(0);
+// Digits may still be freed by other thread_local objects after the counters of the thread are destroyed
+static thread_local bool isExiting = false;
+
+NumberStats::Registration::Registration()
+{
+    clear(this->counters);
+    std::lock_guard<std::mutex> lock(registryMutex);
+    registry.push_back(&this->counters);
+}
+
+NumberStats::Registration::~Registration()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    accumulate(retired, this->counters);
+    registry.erase(std::remove(registry.begin(), registry.end(), &this->counters), registry.end());
+    isExiting = true;
+}
+
+NumberStats::Counters* NumberStats::local()
+{
+    if (isExiting)
+    {
+        return nullptr;
+    }
+    thread_local Registration registration;
+    return &registration.counters;
+}
+
+void NumberStats::increase(std::atomic<uint64_t>& counter, uint64_t value)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+void NumberStats::clear(Counters& counters)
+{
+    for (size_t i = 0; i < OPERATION_COUNT; i++)
+    {
+        counters.operations[i].store(0, std::memory_order_relaxed);
+    }
+    counters.digits.store(0, std::memory_order_relaxed);
+    counters.normalizations.store(0, std::memory_order_relaxed);
+    counters.allocations.store(0, std::memory_order_relaxed);
+    counters.deallocations.store(0, std::memory_order_relaxed);
+    counters.allocatedBytes.store(0, std::memory_order_relaxed);
+}
+
+void NumberStats::accumulate(Snapshot& snapshot, const Counters& counters)
+{
+    for (size_t i = 0; i < OPERATION_COUNT; i++)
+    {
+        snapshot.operations[i] += counters.operations[i].load(std::memory_order_relaxed);
+    }
+    snapshot.digits += counters.digits.load(std::memory_order_relaxed);
+    snapshot.normalizations += counters.normalizations.load(std::memory_order_relaxed);
+    snapshot.allocations += counters.allocations.load(std::memory_order_relaxed);
+    snapshot.deallocations += counters.deallocations.load(std::memory_order_relaxed);
+    snapshot.allocatedBytes += counters.allocatedBytes.load(std::memory_order_relaxed);
+}
+
+NumberStats::Snapshot NumberStats::snapshot()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    Snapshot result = retired;
+    for (const Counters* counters : registry)
+    {
+        accumulate(result, *counters);
+    }
+    result.currentBytes = currentBytes.load(std::memory_order_relaxed);
+    result.peakBytes = peakBytes.load(std::memory_order_relaxed);
+    return result;
+}
+
+void NumberStats::reset()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    retired = Snapshot();
+    for (Counters* counters : registry)
+    {
+        clear(*counters);
+    }
+    // Memory still allocated stays counted
+    peakBytes.store(currentBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+const char* NumberStats::name(Operation operation)
+{
+    static const char* names[OPERATION_COUNT] = { "construct", "copy", "negate", "add", "subtract", "multiply", "divide", "modulo", "compare", "convert" };
+    return operation < OPERATION_COUNT ? names[operation] : "unknown";
+}
+
+void NumberStats::countOperation(Operation operation, size_t digits)
+{
+    Counters* counters = local();
+    if (counters != nullptr)
+    {
+        increase(counters->operations[operation], 1);
+        increase(counters->digits, digits);
+    }
+}
+
+void NumberStats::countNormalization()
+{
+    Counters* counters = local();
+    if (counters != nullptr)
+    {
+        increase(counters->normalizations, 1);
+    }
+}
+
+void NumberStats::countAllocation(size_t bytes)
+{
+    Counters* counters = local();
+    if (counters != nullptr)
+    {
+        increase(counters->allocations, 1);
+        increase(counters->allocatedBytes, bytes);
+    }
+    uint64_t current = currentBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    uint64_t peak = peakBytes.load(std::memory_order_relaxed);
+    while (current > peak && peakBytes.compare_exchange_weak(peak, current, std::memory_order_relaxed) == false)
+    {
+    }
+}
+
+void NumberStats::countDeallocation(size_t bytes)
+{
+    Counters* counters = local();
+    if (counters != nullptr)
+    {
+        increase(counters->deallocations, 1);
+    }
+    currentBytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Counters of Number operations, digits and allocations
+// Define NUMBER_INSTRUMENTATION for the whole build to enable them, otherwise the counting macros compile to nothing
+// and Number uses std::allocator, so the class can stay in the build at no cost
+// Each thread counts into its own counters without locking, snapshot() adds them up
+class NumberStats
+{
+public:
+    enum Operation
+    {
+        CONSTRUCT,
+        COPY,
+        NEGATE,
+        ADD,
+        SUBTRACT,
+        MULTIPLY,
+        DIVIDE,
+        MODULO,
+        COMPARE,
+        CONVERT,
+        OPERATION_COUNT
+    };
+
+    struct Snapshot
+    {
+        uint64_t operations[OPERATION_COUNT];
+        // digits of the operands of all counted operations
+        uint64_t digits;
+        // calls of adjustDigits()
+        uint64_t normalizations;
+        // heap allocations of digit storage
+        uint64_t allocations;
+        uint64_t deallocations;
+        uint64_t allocatedBytes;
+        // digit storage currently allocated, and the most ever allocated at once since the last reset
+        uint64_t currentBytes;
+        uint64_t peakBytes;
+    };
+
+    // Sum of the counters of all threads, including threads which have finished
+    static Snapshot snapshot();
+    // Set all counters to zero, counts made by other threads at the same time may be lost
+    static void reset();
+    // Name of an operation for reports
+    static const char* name(Operation operation);
+
+    // Called through the macros below
+    static void countOperation(Operation operation, size_t digits);
+    static void countNormalization();
+    static void countAllocation(size_t bytes);
+    static void countDeallocation(size_t bytes);
+
+private:
+    // Only the owning thread writes, so increments are plain loads and stores
+    struct Counters
+    {
+        std::atomic<uint64_t> operations[OPERATION_COUNT];
+        std::atomic<uint64_t> digits;
+        std::atomic<uint64_t> normalizations;
+        std::atomic<uint64_t> allocations;
+        std::atomic<uint64_t> deallocations;
+        std::atomic<uint64_t> allocatedBytes;
+    };
+
+    // Registers the counters of a thread and keeps their counts when the thread exits
+    struct Registration
+    {
+        Counters counters;
+        Registration();
+        ~Registration();
+    };
+
+    // Counters of the running threads, and the sum of the threads which have finished
+    static std::mutex registryMutex;
+    static std::vector<Counters*> registry;
+    static Snapshot retired;
+
+    // Counters of the calling thread, nullptr while the thread is exiting
+    static Counters* local();
+    static void increase(std::atomic<uint64_t>& counter, uint64_t value);
+    static void clear(Counters& counters);
+    static void accumulate(Snapshot& snapshot, const Counters& counters);
+};
+
+// Allocator for digit vectors which reports to NumberStats
+template <typename T>
+class NumberCountingAllocator
+{
+public:
+    typedef T value_type;
+
+    NumberCountingAllocator() noexcept
+    {
+    }
+
+    template <typename U>
+    NumberCountingAllocator(const NumberCountingAllocator<U>&) noexcept
+    {
+    }
+
+    T* allocate(size_t n)
+    {
+        NumberStats::countAllocation(n * sizeof(T));
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n)
+    {
+        NumberStats::countDeallocation(n * sizeof(T));
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U>
+    bool operator == (const NumberCountingAllocator<U>&) const noexcept
+    {
+        return true;
+    }
+
+    template <typename U>
+    bool operator != (const NumberCountingAllocator<U>&) const noexcept
+    {
+        return false;
+    }
+};
+
+#ifdef NUMBER_INSTRUMENTATION
+template <typename T>
+using NumberAllocator = NumberCountingAllocator<T>;
+#define NUMBER_COUNT_OPERATION(operation, digits) NumberStats::countOperation(NumberStats::operation, (digits))
+#define NUMBER_COUNT_NORMALIZATION() NumberStats::countNormalization()
+#else
+template <typename T>
+using NumberAllocator = std::allocator<T>;
+#define NUMBER_COUNT_OPERATION(operation, digits) ((void)0)
+#define NUMBER_COUNT_NORMALIZATION() ((void)0)
+#endif
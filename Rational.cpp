@@ -0,0 +1,241 @@
+#include "Rational.h"
+
+#include <stdexcept>
+
+void Rational::reduce() const
+{
+    if (this->isReduced)
+    {
+        return;
+    }
+    NumberKernel::Limbs n = this->numerator.toLimbs();
+    NumberKernel::Limbs d = this->denominator.toLimbs();
+    NumberKernel::Limbs g = NumberKernel::gcd(n, d, LIMB_BASE);
+    if (g.size() != 1 || g[0] != 1)
+    {
+        NumberKernel::Limbs q;
+        NumberKernel::divide(n, g, LIMB_BASE, &q, nullptr);
+        this->numerator = Number::fromLimbs(q, 0, this->numerator.isNegative, DEFAULT_LENGTH);
+        NumberKernel::divide(d, g, LIMB_BASE, &q, nullptr);
+        this->denominator = Number::fromLimbs(q, 0, false, DEFAULT_LENGTH);
+    }
+    this->isReduced = true;
+    this->reducedDigits = this->digits();
+}
+
+void Rational::reduceIfLarge()
+{
+    if (this->digits() > this->reducedDigits * 2 + RATIONAL_REDUCE_THRESHOLD)
+    {
+        this->reduce();
+    }
+}
+
+size_t Rational::digits() const
+{
+    return this->numerator.primary.size() + this->denominator.primary.size();
+}
+
+void Rational::negate(Number& n)
+{
+    if (n.isZero() == false)
+    {
+        n.isNegative = (!n.isNegative);
+        n.resetHash();
+    }
+}
+
+Rational::Rational()
+{
+    this->numerator = Number(0);
+    this->denominator = Number(1);
+    this->isReduced = true;
+    this->reducedDigits = 2;
+}
+
+Rational::Rational(int n)
+{
+    this->numerator = Number(n);
+    this->denominator = Number(1);
+    this->isReduced = true;
+    this->reducedDigits = this->digits();
+}
+
+Rational::Rational(const Number& n)
+{
+    // n = (all digits) / 10^(decimal digits)
+    this->numerator = Number::fromLimbs(n.toLimbs(), 0, n.isNegative, DEFAULT_LENGTH);
+    this->denominator = Number::fromLimbs(Number(1).toLimbs(n.decimal.size()), 0, false, DEFAULT_LENGTH);
+    this->isReduced = (n.decimal.size() == 0);
+    this->reducedDigits = this->isReduced ? this->digits() : 0;
+    this->reduceIfLarge();
+}
+
+Rational::Rational(const Number& numerator, const Number& denominator)
+{
+    *this = Rational(numerator) / Rational(denominator);
+}
+
+Rational::Rational(std::string n)
+{
+    size_t slash = n.find('/');
+    if (slash == std::string::npos)
+    {
+        *this = Rational(Number(n));
+    }
+    else
+    {
+        *this = Rational(Number(n.substr(0, slash)), Number(n.substr(slash + 1)));
+    }
+}
+
+Rational::Rational(const Rational& r)
+{
+    this->numerator = r.numerator;
+    this->denominator = r.denominator;
+    this->isReduced = r.isReduced;
+    this->reducedDigits = r.reducedDigits;
+}
+
+Rational Rational::operator - () const
+{
+    Rational result = *this;
+    negate(result.numerator);
+    return result;
+}
+
+Rational& Rational::operator = (const Rational& r)
+{
+    this->numerator = r.numerator;
+    this->denominator = r.denominator;
+    this->isReduced = r.isReduced;
+    this->reducedDigits = r.reducedDigits;
+    return *this;
+}
+
+Rational Rational::operator + (const Rational& r) const
+{
+    Rational result;
+    if (this->denominator == r.denominator)
+    {
+        result.numerator = this->numerator + r.numerator;
+        result.denominator = this->denominator;
+    }
+    else
+    {
+        result.numerator = this->numerator * r.denominator + r.numerator * this->denominator;
+        result.denominator = this->denominator * r.denominator;
+    }
+    result.isReduced = false;
+    result.reducedDigits = this->reducedDigits > r.reducedDigits ? this->reducedDigits : r.reducedDigits;
+    result.reduceIfLarge();
+    return result;
+}
+
+Rational Rational::operator - (const Rational& r) const
+{
+    return (*this) + (-r);
+}
+
+Rational Rational::operator * (const Rational& r) const
+{
+    Rational result;
+    result.numerator = this->numerator * r.numerator;
+    result.denominator = this->denominator * r.denominator;
+    result.isReduced = false;
+    result.reducedDigits = this->reducedDigits > r.reducedDigits ? this->reducedDigits : r.reducedDigits;
+    result.reduceIfLarge();
+    return result;
+}
+
+Rational Rational::operator / (const Rational& r) const
+{
+    if (r.numerator.isZero())
+    {
+        throw std::domain_error("Rational: division by zero");
+    }
+    Rational result;
+    result.numerator = this->numerator * r.denominator;
+    result.denominator = r.numerator * this->denominator;
+    if (result.denominator.isNegative)
+    {
+        negate(result.numerator);
+        negate(result.denominator);
+    }
+    result.isReduced = false;
+    result.reducedDigits = this->reducedDigits > r.reducedDigits ? this->reducedDigits : r.reducedDigits;
+    result.reduceIfLarge();
+    return result;
+}
+
+bool Rational::operator == (const Rational& r) const
+{
+    // Reduced fractions are unique
+    this->reduce();
+    r.reduce();
+    return this->numerator == r.numerator && this->denominator == r.denominator;
+}
+
+bool Rational::operator != (const Rational& r) const
+{
+    return !((*this) == r);
+}
+
+bool Rational::operator < (const Rational& r) const
+{
+    // Denominators are positive, so a / b < c / d is the same as a * d < c * b
+    this->reduce();
+    r.reduce();
+    return this->numerator * r.denominator < r.numerator * this->denominator;
+}
+
+bool Rational::operator > (const Rational& r) const
+{
+    return r < (*this);
+}
+
+bool Rational::operator <= (const Rational& r) const
+{
+    return !(r < (*this));
+}
+
+bool Rational::operator >= (const Rational& r) const
+{
+    return !((*this) < r);
+}
+
+Number Rational::getNumerator() const
+{
+    this->reduce();
+    return this->numerator;
+}
+
+Number Rational::getDenominator() const
+{
+    this->reduce();
+    return this->denominator;
+}
+
+Number Rational::toNumber(size_t decimalLength) const
+{
+    NumberKernel::Limbs quotient;
+    NumberKernel::divide(this->numerator.toLimbs(decimalLength), this->denominator.toLimbs(), LIMB_BASE, &quotient, nullptr);
+    return Number::fromLimbs(quotient, decimalLength, this->numerator.isNegative, decimalLength);
+}
+
+Rational::operator double() const
+{
+    return (double)this->toNumber();
+}
+
+Rational::operator std::string() const
+{
+    this->reduce();
+    std::string result = this->numerator;
+    if (this->denominator.primary.size() != 1 || this->denominator.primary[0] != 1)
+    {
+        result += "/";
+        result += (std::string)this->denominator;
+    }
+    return result;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Number.h"
+
+// The fraction is reduced again once it has more than 2 * (digits after the last reduction) + RATIONAL_REDUCE_THRESHOLD digits
+#define RATIONAL_REDUCE_THRESHOLD 64
+
+// Exact fraction with Number integers as numerator and denominator, the denominator is always positive
+// The fraction is reduced lazily: only when it grows beyond the threshold, or when it is compared, printed or queried
+// Since a const instance may still reduce its internal representation, please lock the instance in a multi-thread environment
+class Rational
+{
+private:
+    // carry the sign of the fraction
+    mutable Number numerator;
+    // always positive
+    mutable Number denominator;
+    // true if numerator and denominator are coprime
+    mutable bool isReduced;
+    // total digits of numerator and denominator after the last reduction
+    mutable size_t reducedDigits;
+
+    // Divide numerator and denominator by their greatest common divisor
+    void reduce() const;
+    // Reduce only if the fraction grew beyond the threshold since the last reduction
+    void reduceIfLarge();
+    // Total digits of numerator and denominator
+    size_t digits() const;
+    // Flip the sign of the numerator, zero stays positive
+    static void negate(Number& n);
+
+public:
+    Rational();
+    Rational(int n);
+    // Exact conversion, for example 0.25 becomes 1/4
+    Rational(const Number& n);
+    // Decimals are accepted and converted exactly, throw std::domain_error if denominator is zero
+    Rational(const Number& numerator, const Number& denominator);
+    // Accept both "numerator/denominator" and decimal text such as "-12.5"
+    Rational(std::string n);
+    Rational(const Rational& r);
+
+    Rational operator - () const;
+    Rational& operator = (const Rational& r);
+    Rational operator + (const Rational& r) const;
+    Rational operator - (const Rational& r) const;
+    Rational operator * (const Rational& r) const;
+    // Throw std::domain_error if r is zero
+    Rational operator / (const Rational& r) const;
+    bool operator == (const Rational& r) const;
+    bool operator != (const Rational& r) const;
+    bool operator < (const Rational& r) const;
+    bool operator > (const Rational& r) const;
+    bool operator <= (const Rational& r) const;
+    bool operator >= (const Rational& r) const;
+
+    // Get the numerator of the reduced fraction, it carries the sign
+    Number getNumerator() const;
+    // Get the denominator of the reduced fraction, it is always positive
+    Number getDenominator() const;
+    // Convert to a decimal, digits after decimalLength are truncated
+    Number toNumber(size_t decimalLength = DEFAULT_LENGTH) const;
+
+    operator double() const;
+    // Format as "numerator/denominator", or just "numerator" if the denominator is 1
+    operator std::string() const;
+};
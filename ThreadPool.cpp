@@ -0,0 +1,186 @@
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <pthread.h>
+#endif
+
+ThreadPool::ThreadPool(unsigned int threads, bool isPinned)
+{
+    this->isStopping = false;
+    if (threads == 0)
+    {
+        threads = std::thread::hardware_concurrency();
+        threads = threads > 0 ? threads : 1;
+    }
+    for (unsigned int i = 0; i < threads; i++)
+    {
+        this->workers.emplace_back(&ThreadPool::work, this);
+        if (isPinned)
+        {
+            pin(this->workers.back(), i);
+        }
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->isStopping = true;
+    }
+    this->condition.notify_all();
+    for (std::thread& worker : this->workers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::pin(std::thread& thread, unsigned int processor)
+{
+    unsigned int count = std::thread::hardware_concurrency();
+    processor = count > 0 ? processor % count : 0;
+#ifdef _WIN32
+    if (processor < sizeof(DWORD_PTR) * 8)
+    {
+        SetThreadAffinityMask(thread.native_handle(), (DWORD_PTR)1 << processor);
+    }
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(processor, &set);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+    (void)thread;
+#endif
+}
+
+void ThreadPool::work()
+{
+    while (true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->condition.wait(lock, [this]() { return this->isStopping || this->jobs.size() > 0; });
+            if (this->jobs.size() == 0)
+            {
+                return;
+            }
+            job = std::move(this->jobs.front());
+            this->jobs.pop_front();
+        }
+        job();
+    }
+}
+
+bool ThreadPool::runOne()
+{
+    std::function<void()> job;
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (this->jobs.size() == 0)
+        {
+            return false;
+        }
+        // Take the newest job, it is most likely part of the caller's own work
+        job = std::move(this->jobs.back());
+        this->jobs.pop_back();
+    }
+    job();
+    return true;
+}
+
+size_t ThreadPool::size() const
+{
+    return this->workers.size();
+}
+
+void ThreadPool::run(const std::vector<std::function<void()>>& tasks)
+{
+    if (tasks.size() == 0)
+    {
+        return;
+    }
+    struct Group
+    {
+        std::atomic<size_t> remaining;
+        std::exception_ptr error;
+        std::mutex mutex;
+    };
+    std::shared_ptr<Group> group = std::make_shared<Group>();
+    group->remaining = tasks.size();
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        // The first task is run by the calling thread
+        for (size_t i = 1; i < tasks.size(); i++)
+        {
+            const std::function<void()>* task = &tasks[i];
+            this->jobs.emplace_back([this, group, task]()
+            {
+                try
+                {
+                    (*task)();
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(group->mutex);
+                    group->error = group->error ? group->error : std::current_exception();
+                }
+                if (--group->remaining == 0)
+                {
+                    // Lock so the notification cannot slip between the check and the wait of the caller
+                    std::lock_guard<std::mutex> lock(this->mutex);
+                    this->condition.notify_all();
+                }
+            });
+        }
+    }
+    this->condition.notify_all();
+    try
+    {
+        tasks[0]();
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(group->mutex);
+        group->error = group->error ? group->error : std::current_exception();
+    }
+    group->remaining--;
+    while (group->remaining > 0)
+    {
+        if (this->runOne() == false)
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->condition.wait(lock, [this, &group]() { return group->remaining == 0 || this->jobs.size() > 0; });
+        }
+    }
+    if (group->error)
+    {
+        std::rethrow_exception(group->error);
+    }
+}
+
+void ThreadPool::parallelFor(size_t first, size_t last, size_t grain, const std::function<void(size_t, size_t)>& body)
+{
+    if (last <= first)
+    {
+        return;
+    }
+    grain = grain > 0 ? grain : 1;
+    // A few chunks per thread balance uneven work
+    size_t chunks = (this->workers.size() + 1) * 4;
+    size_t size = (last - first + chunks - 1) / chunks;
+    size = size > grain ? size : grain;
+    std::vector<std::function<void()>> tasks;
+    for (size_t begin = first; begin < last; begin += size)
+    {
+        size_t end = last - begin > size ? begin + size : last;
+        tasks.push_back([&body, begin, end]() { body(begin, end); });
+    }
+    this->run(tasks);
+}
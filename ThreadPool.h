@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Fixed set of worker threads running jobs from one shared queue
+// A thread waiting in run() or parallelFor() keeps running queued jobs, so jobs can start nested parallel work without deadlock
+class ThreadPool
+{
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool isStopping;
+
+    // Main loop of a worker thread
+    void work();
+    // Run one queued job if there is any, return false if the queue is empty
+    bool runOne();
+    // Bind a thread to a logical processor, ignored on unsupported platforms
+    static void pin(std::thread& thread, unsigned int processor);
+
+public:
+    // threads = 0 means one thread per hardware thread, isPinned binds worker i to logical processor i
+    ThreadPool(unsigned int threads = 0, bool isPinned = false);
+    // Wait for the queued jobs to finish and stop the workers
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator = (const ThreadPool&) = delete;
+
+    // Number of worker threads
+    size_t size() const;
+    // Run all tasks and wait for them, the calling thread helps; the first exception thrown by a task is rethrown
+    void run(const std::vector<std::function<void()>>& tasks);
+    // Call body(begin, end) for chunks of [first, last) with at least grain items each, in parallel
+    void parallelFor(size_t first, size_t last, size_t grain, const std::function<void(size_t, size_t)>& body);
+};
@@ -0,0 +1,271 @@
+// Benchmark of the basic Number operations from 10 to 10^7 digits, the results are written as JSON
+// Usage: NumberBenchmark [-o results.json] [-m max digits] [-b seconds per case]
+// Build with -DNUMBER_BENCHMARK_GMP and link -lgmp to add GMP results for comparison
+#include "../Number.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifdef NUMBER_BENCHMARK_GMP
+#include <gmp.h>
+#endif
+
+// Warmup time before the trials of each case
+#define BENCHMARK_WARMUP_TIME 0.05
+// A trial repeats the operation until it takes at least this long
+#define BENCHMARK_TRIAL_TIME 0.0001
+#define BENCHMARK_MAX_TRIALS 1000
+#define BENCHMARK_MIN_TRIALS 5
+
+// Every allocation of the process is counted, the benchmark itself only allocates outside the timed loops
+static std::atomic<size_t> allocationCount(0);
+static std::atomic<size_t> allocationBytes(0);
+
+void* operator new(size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocationBytes.fetch_add(size, std::memory_order_relaxed);
+    void* p = std::malloc(size > 0 ? size : 1);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+struct BenchmarkResult
+{
+    std::string library;
+    std::string operation;
+    size_t digits;
+    size_t trials;
+    // nanoseconds per operation
+    double median;
+    double p99;
+    double allocations;
+    double bytes;
+};
+
+static std::mt19937_64 generator(2024);
+
+static std::string randomDigits(size_t digits)
+{
+    std::string result(digits, '0');
+    for (size_t i = 0; i < digits; i++)
+    {
+        result[i] = (char)('0' + generator() % 10);
+    }
+    result[0] = (char)('1' + generator() % 9);
+    return result;
+}
+
+static double now()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Run the operation with warmup and repeated trials, stop early once the time budget is used
+template <typename Operation>
+static BenchmarkResult measure(const std::string& library, const std::string& name, size_t digits, double budget, Operation operation)
+{
+    BenchmarkResult result = { library, name, digits, 0, 0, 0, 0, 0 };
+    // Warm up and find how many operations make a trial long enough
+    size_t batch = 1;
+    double start = now();
+    double elapsed = 0;
+    while (true)
+    {
+        double begin = now();
+        for (size_t i = 0; i < batch; i++)
+        {
+            operation();
+        }
+        elapsed = now() - begin;
+        if (now() - start >= BENCHMARK_WARMUP_TIME || now() - start >= budget)
+        {
+            break;
+        }
+        batch = elapsed < BENCHMARK_TRIAL_TIME ? batch * 2 : batch;
+    }
+    std::vector<double> times;
+    size_t operations = 0;
+    size_t count = allocationCount.load();
+    size_t bytes = allocationBytes.load();
+    start = now();
+    while (times.size() < BENCHMARK_MAX_TRIALS && (times.size() < BENCHMARK_MIN_TRIALS || now() - start < budget))
+    {
+        double begin = now();
+        for (size_t i = 0; i < batch; i++)
+        {
+            operation();
+        }
+        times.push_back((now() - begin) / batch * 1e9);
+        operations += batch;
+        // A single slow trial already uses the budget
+        if (now() - start >= budget && times.size() >= 1 && times.back() * BENCHMARK_MIN_TRIALS > budget * 1e9)
+        {
+            break;
+        }
+    }
+    result.allocations = (double)(allocationCount.load() - count) / operations;
+    result.bytes = (double)(allocationBytes.load() - bytes) / operations;
+    std::sort(times.begin(), times.end());
+    result.trials = times.size();
+    result.median = times[times.size() / 2];
+    result.p99 = times[std::min(times.size() - 1, times.size() * 99 / 100)];
+    return result;
+}
+
+static void report(std::vector<BenchmarkResult>& results, const BenchmarkResult& result)
+{
+    std::cerr << result.library << " " << result.operation << " " << result.digits << " digits: median " << result.median << " ns, p99 " << result.p99 << " ns, "
+        << result.allocations << " allocations, " << result.bytes << " bytes" << std::endl;
+    results.push_back(result);
+}
+
+static std::string toJson(const std::vector<BenchmarkResult>& results)
+{
+    std::ostringstream output;
+    output << "{\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BenchmarkResult& r = results[i];
+        output << "    { \"library\": \"" << r.library << "\", \"operation\": \"" << r.operation << "\", \"digits\": " << r.digits
+            << ", \"trials\": " << r.trials << ", \"median_ns\": " << r.median << ", \"p99_ns\": " << r.p99
+            << ", \"allocations_per_op\": " << r.allocations << ", \"bytes_per_op\": " << r.bytes << " }"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    output << "  ]\n}\n";
+    return output.str();
+}
+
+int main(int argc, char** argv)
+{
+    std::string outputPath;
+    size_t maxDigits = 10000000;
+    double budget = 2;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string option = argv[i];
+        if (option == "-o")
+        {
+            outputPath = argv[i + 1];
+        }
+        else if (option == "-m")
+        {
+            maxDigits = (size_t)std::strtoull(argv[i + 1], nullptr, 10);
+        }
+        else if (option == "-b")
+        {
+            budget = std::strtod(argv[i + 1], nullptr);
+        }
+        else
+        {
+            std::cerr << "Usage: NumberBenchmark [-o results.json] [-m max digits] [-b seconds per case]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<BenchmarkResult> results;
+    // Construction from machine types does not depend on the size
+    volatile int intValue = 1234567890;
+    volatile double doubleValue = 12345.678901;
+    report(results, measure("Number", "Number(int)", 10, budget, [&]() { Number n((int)intValue); }));
+    report(results, measure("Number", "Number(double)", 10, budget, [&]() { Number n((double)doubleValue); }));
+
+    // Once an operation exceeds the budget in one call, larger sizes are skipped
+    std::vector<std::string> skipped;
+    auto isSkipped = [&](const std::string& name)
+    {
+        return std::find(skipped.begin(), skipped.end(), name) != skipped.end();
+    };
+    auto run = [&](const std::string& name, size_t digits, const std::function<void()>& operation)
+    {
+        if (isSkipped(name))
+        {
+            return;
+        }
+        BenchmarkResult result = measure("Number", name, digits, budget, operation);
+        report(results, result);
+        if (result.median > budget * 1e9 / BENCHMARK_MIN_TRIALS)
+        {
+            skipped.push_back(name);
+        }
+    };
+    for (size_t digits = 10; digits <= maxDigits; digits *= 10)
+    {
+        std::string textA = randomDigits(digits);
+        std::string textB = randomDigits(digits);
+        Number a(textA);
+        Number b(textB);
+        // Comparing equal values scans every digit
+        Number c = a;
+        // Raw digits out of range make the constructor carry through adjustDigits
+        std::vector<int> raw(digits);
+        for (size_t i = 0; i < digits; i++)
+        {
+            raw[i] = (int)(generator() % 20);
+        }
+        volatile bool flag = false;
+        run("Number(string)", digits, [&]() { Number n(textA); });
+        run("operator+", digits, [&]() { Number n = a + b; });
+        run("operator-", digits, [&]() { Number n = a - b; });
+        run("operator==", digits, [&]() { flag = (a == c); });
+        run("operator<", digits, [&]() { flag = (a < c); });
+        run("adjustDigits", digits, [&]() { Number n(false, raw.data(), raw.size(), nullptr, 0); });
+        run("operator std::string", digits, [&]() { std::string s = (std::string)a; });
+#ifdef NUMBER_BENCHMARK_GMP
+        mpz_t x;
+        mpz_t y;
+        mpz_t z;
+        mpz_init_set_str(x, textA.c_str(), 10);
+        mpz_init_set_str(y, textB.c_str(), 10);
+        mpz_init(z);
+        std::vector<char> buffer(digits + 2);
+        report(results, measure("GMP", "mpz_set_str", digits, budget, [&]() { mpz_set_str(z, textA.c_str(), 10); }));
+        report(results, measure("GMP", "mpz_add", digits, budget, [&]() { mpz_add(z, x, y); }));
+        report(results, measure("GMP", "mpz_sub", digits, budget, [&]() { mpz_sub(z, x, y); }));
+        report(results, measure("GMP", "mpz_cmp", digits, budget, [&]() { flag = mpz_cmp(x, y) < 0; }));
+        report(results, measure("GMP", "mpz_get_str", digits, budget, [&]() { mpz_get_str(buffer.data(), 10, x); }));
+        mpz_clear(x);
+        mpz_clear(y);
+        mpz_clear(z);
+#endif
+    }
+
+    std::string json = toJson(results);
+    if (outputPath.size() > 0)
+    {
+        std::ofstream file(outputPath);
+        file << json;
+        if (file.good() == false)
+        {
+            std::cerr << "Cannot write " << outputPath << std::endl;
+            return 1;
+        }
+    }
+    else
+    {
+        std::cout << json;
+    }
+    return 0;
+}
@@ -0,0 +1,80 @@
+// Interactive calculator on top of NumberExpression and Display
+// Usage: calculator
+// Enter a formula to see its value, "name = formula" to store the value in a variable, or an empty line to quit
+#include "../Display.h"
+#include "../NumberExpression.h"
+
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+int main()
+{
+    Display display;
+    std::map<std::string, Number> memory;
+    while (true)
+    {
+        display.showText("&6> &r");
+        std::string line = display.getInputText(0, SIZE_MAX, false);
+        if (line.find_first_not_of(" \t") == std::string::npos)
+        {
+            break;
+        }
+        // Split an assignment
+        std::string name;
+        // The prompt is 2 characters wide
+        size_t column = 2;
+        size_t equals = line.find('=');
+        if (equals != std::string::npos)
+        {
+            name = line.substr(0, equals);
+            name.erase(0, name.find_first_not_of(" \t"));
+            name.erase(name.find_last_not_of(" \t") + 1);
+            line = line.substr(equals + 1);
+            column += equals + 1;
+        }
+
+        NumberExpression expression;
+        if (expression.compile(line) == false)
+        {
+            display.showText("&c" + std::string(column + expression.getErrorPosition(), ' ') + "^ " + expression.getError() + "\n");
+            continue;
+        }
+        std::vector<Number> values;
+        std::string missing;
+        for (const std::string& variable : expression.getVariables())
+        {
+            auto found = memory.find(variable);
+            if (found == memory.end())
+            {
+                missing = variable;
+                break;
+            }
+            values.push_back(found->second);
+        }
+        if (missing.size() > 0)
+        {
+            display.showText("&cunknown variable ", missing, "\n");
+            continue;
+        }
+        try
+        {
+            Number value = expression.evaluate(values);
+            if (name.size() > 0)
+            {
+                memory[name] = value;
+                display.showText("&b" + name + " = &a", (std::string)value, "\n");
+            }
+            else
+            {
+                display.showText("&a", (std::string)value, "\n");
+            }
+        }
+        catch (const std::domain_error& e)
+        {
+            display.showText("&c", e.what(), "\n");
+        }
+    }
+    return 0;
+}
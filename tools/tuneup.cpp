@@ -0,0 +1,189 @@
+// Measure the crossover points of the NumberKernel multiplication and radix conversion algorithms on this machine, in the spirit of GMP's tuneup
+// Usage: tuneup [-o thresholds.txt] [-h NumberThresholds.h]
+// The text file can be loaded with NumberKernel::loadThresholds(), or at startup by setting NUMBER_THRESHOLDS to its path
+// The header can be force included (-include NumberThresholds.h) to compile the thresholds in as the defaults
+#include "../NumberKernel.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+
+// Each measurement repeats the operation for at least this long
+#define TUNE_MIN_TIME 0.02
+// A crossover is accepted once the faster algorithm wins this many sizes in a row
+#define TUNE_CONFIRM 3
+#define TUNE_INFINITY ((size_t)-1)
+
+static std::mt19937 generator(12345);
+
+static NumberKernel::Limbs randomLimbs(size_t n)
+{
+    NumberKernel::Limbs result(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        result[i] = generator() % 10000;
+    }
+    result[n - 1] = 1 + generator() % 9999;
+    return result;
+}
+
+// Seconds per multiplication of two n-limb numbers with the given thresholds, the best of three runs
+static double timeMultiply(size_t n, size_t karatsuba, size_t ntt, size_t parallel)
+{
+    NumberKernel::setThresholds(karatsuba, ntt, parallel);
+    NumberKernel::Limbs a = randomLimbs(n);
+    NumberKernel::Limbs b = randomLimbs(n);
+    double best = 1e100;
+    for (int run = 0; run < 3; run++)
+    {
+        size_t count = 0;
+        double elapsed = 0;
+        auto start = std::chrono::steady_clock::now();
+        while (elapsed < TUNE_MIN_TIME)
+        {
+            NumberKernel::multiply(a, b, 10000);
+            count++;
+            elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        best = elapsed / count < best ? elapsed / count : best;
+    }
+    return best;
+}
+
+// Seconds per conversion of an n-limb number from base 10000 to base 65536 with the given radix threshold, the best of three runs
+static double timeConvert(size_t n, size_t radix)
+{
+    NumberKernel::setRadixThreshold(radix);
+    NumberKernel::Limbs a = randomLimbs(n);
+    double best = 1e100;
+    for (int run = 0; run < 3; run++)
+    {
+        size_t count = 0;
+        double elapsed = 0;
+        auto start = std::chrono::steady_clock::now();
+        while (elapsed < TUNE_MIN_TIME)
+        {
+            NumberKernel::convert(a, 10000, 65536);
+            count++;
+            elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        best = elapsed / count < best ? elapsed / count : best;
+    }
+    return best;
+}
+
+// Find the first size from which "above" (the threshold set to the size) beats "below" (the threshold set above the size)
+// setup(n, isAbove) returns the time of one configuration, next(n) returns the next size to try
+template <typename Setup, typename Next>
+static size_t findCrossover(const char* name, size_t first, size_t last, Setup setup, Next next, size_t fallback)
+{
+    size_t candidate = 0;
+    int wins = 0;
+    for (size_t n = first; n <= last; n = next(n))
+    {
+        double below = setup(n, false);
+        double above = setup(n, true);
+        std::cout << name << " " << n << " limbs: " << below * 1e6 << " us vs " << above * 1e6 << " us" << std::endl;
+        if (above < below)
+        {
+            candidate = wins == 0 ? n : candidate;
+            wins++;
+            if (wins >= TUNE_CONFIRM)
+            {
+                return candidate;
+            }
+        }
+        else
+        {
+            wins = 0;
+        }
+    }
+    std::cout << name << ": no stable crossover found, keep " << fallback << std::endl;
+    return fallback;
+}
+
+int main(int argc, char** argv)
+{
+    std::string textPath = "thresholds.txt";
+    std::string headerPath;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string option = argv[i];
+        if (option == "-o")
+        {
+            textPath = argv[i + 1];
+        }
+        else if (option == "-h")
+        {
+            headerPath = argv[i + 1];
+        }
+        else
+        {
+            std::cerr << "Usage: tuneup [-o thresholds.txt] [-h NumberThresholds.h]" << std::endl;
+            return 1;
+        }
+    }
+
+    // Schoolbook against one level of Karatsuba, the halves are multiplied with schoolbook in both cases
+    size_t karatsuba = findCrossover("KARATSUBA_THRESHOLD", 4, 512, [](size_t n, bool isAbove)
+    {
+        return timeMultiply(n, isAbove ? n : n + 1, TUNE_INFINITY, TUNE_INFINITY);
+    }, [](size_t n) { return n + (n / 8 > 1 ? n / 8 : 1); }, KARATSUBA_THRESHOLD);
+
+    // Karatsuba against NTT
+    size_t ntt = findCrossover("NTT_THRESHOLD", 128, 65536, [karatsuba](size_t n, bool isAbove)
+    {
+        return timeMultiply(n, karatsuba, isAbove ? n : TUNE_INFINITY, TUNE_INFINITY);
+    }, [](size_t n) { return n + n / 4; }, NTT_THRESHOLD);
+
+    // Serial against the thread pool, only meaningful with more than one hardware thread
+    size_t parallel = PARALLEL_THRESHOLD;
+    if (std::thread::hardware_concurrency() > 1)
+    {
+        NumberKernel::setParallel(0);
+        parallel = findCrossover("PARALLEL_THRESHOLD", 256, 262144, [karatsuba, ntt](size_t n, bool isAbove)
+        {
+            return timeMultiply(n, karatsuba, ntt, isAbove ? n : TUNE_INFINITY);
+        }, [](size_t n) { return n + n / 2; }, PARALLEL_THRESHOLD);
+        NumberKernel::setParallel(1);
+    }
+    else
+    {
+        std::cout << "PARALLEL_THRESHOLD: single hardware thread, keep " << parallel << std::endl;
+    }
+
+    // Horner's rule against one split, with the tuned multiplication thresholds
+    NumberKernel::setThresholds(karatsuba, ntt, parallel);
+    size_t radix = findCrossover("RADIX_THRESHOLD", 8, 4096, [](size_t n, bool isAbove)
+    {
+        return timeConvert(n, isAbove ? n - 1 : n);
+    }, [](size_t n) { return n + (n / 8 > 1 ? n / 8 : 1); }, RADIX_THRESHOLD);
+
+    NumberKernel::setRadixThreshold(radix);
+    if (NumberKernel::saveThresholds(textPath) == false)
+    {
+        std::cerr << "Cannot write " << textPath << std::endl;
+        return 1;
+    }
+    std::cout << "Thresholds written to " << textPath << std::endl;
+    if (headerPath.size() > 0)
+    {
+        std::ofstream header(headerPath);
+        header << "#pragma once\n\n";
+        header << "// Generated by tools/tuneup\n";
+        header << "#define KARATSUBA_THRESHOLD " << karatsuba << "\n";
+        header << "#define NTT_THRESHOLD " << ntt << "\n";
+        header << "#define PARALLEL_THRESHOLD " << parallel << "\n";
+        header << "#define RADIX_THRESHOLD " << radix << "\n";
+        if (header.good() == false)
+        {
+            std::cerr << "Cannot write " << headerPath << std::endl;
+            return 1;
+        }
+        std::cout << "Header written to " << headerPath << std::endl;
+    }
+    return 0;
+}